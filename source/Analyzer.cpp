@@ -0,0 +1,297 @@
+#include "Analyzer.h"
+
+#include "llvm/Support/CommandLine.h"
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "Buffer.h"
+#include "ConstraintGenerator.h"
+#include "Helpers.h"
+#include "LinearProblem.h"
+#include "LocationTable.h"
+#include "log.h"
+#include "Profiler.h"
+#include "VarTable.h"
+
+using std::cerr;
+using std::ofstream;
+using std::stringstream;
+using std::vector;
+
+using boa::Helpers::JsonString;
+using boa::Helpers::SplitString;
+
+using namespace llvm;
+
+cl::opt<string> LogFile("logfile", cl::desc("Log to filename"), cl::value_desc("filename"));
+cl::opt<string> LogLevel("loglevel", cl::desc("Most verbose log level - error, info, debug or trace"),
+                         cl::value_desc("level"), cl::init("trace"));
+cl::opt<string> ProfileFile("profile", cl::desc("Write a JSON phase profile to filename"),
+                            cl::value_desc("filename"));
+cl::opt<int> Jobs("jobs", cl::desc("Number of solver threads, 0 for the number of processors"),
+                  cl::value_desc("N"), cl::init(0));
+cl::opt<bool> OutputGlpk("output_glpk", cl::desc("Show GLPK Output"), cl::value_desc(""));
+cl::opt<bool> Blame("blame", cl::desc("Calculate and show Blame information"), cl::value_desc(""));
+cl::opt<bool> NoPointerAnalysis("no_pointer_analysis",
+                   cl::desc("Do not generate pointer analysis constraints"), cl::value_desc(""));
+cl::opt<bool> NoGraphSolver("no_graph_solver",
+                   cl::desc("Solve difference constraints with glpk too"), cl::value_desc(""));
+cl::opt<bool> NoPresolve("no_presolve",
+                   cl::desc("Load the problem into glpk without presolving"), cl::value_desc(""));
+cl::opt<bool> NoSummaries("no_summaries",
+                   cl::desc("Analyze every call with the shared body of the called function"),
+                   cl::value_desc(""));
+cl::opt<string> CacheDir("cache_dir",
+                   cl::desc("Reuse the constraints of unchanged functions, cached in directory"),
+                   cl::value_desc("directory"));
+cl::opt<bool> NoWarmStart("no_warm_start",
+                   cl::desc("Solve every linear problem from scratch"), cl::value_desc(""));
+cl::opt<bool> SingleIIS("single_iis",
+                   cl::desc("Remove one infeasable set in each repair round"), cl::value_desc(""));
+cl::opt<bool> IgnoreLiterals("ignore_literals",
+                   cl::desc("Don't report buffer overruns on string literals"), cl::value_desc(""));
+cl::opt<string> ResultsFile("results",
+                   cl::desc("Write the verdict of each buffer to filename as a JSON line, as soon "
+                            "as it is known"), cl::value_desc("filename"));
+cl::opt<bool> Stream("stream", cl::desc("Report each overrun as soon as it is found"),
+                     cl::value_desc(""));
+cl::opt<bool> Verbose("v", cl::desc("Verbose output format"), cl::value_desc(""));
+cl::opt<string> SafeFunctions("safe_functions", cl::desc("Names of safe functions"), cl::value_desc(""));
+cl::opt<string> UnsafeFunctions("unsafe_functions", cl::desc("Names of unsafe functions"), cl::value_desc(""));
+cl::opt<string> Models("models",
+                   cl::desc("Files of library models (see ModelTable.h), later files override "
+                            "earlier ones and the libc models"), cl::value_desc("file,..."));
+
+namespace boa {
+static const string SEPARATOR("---");
+
+namespace Colors {
+  static string Red, Green, Normal, Bold;
+  static void Setup(bool enable) {
+    Red     = enable ? "\033[0;31m" : "";
+    Green   = enable ? "\033[0;32m" : "";
+    Normal  = enable ? "\033[0m" : "";
+    Bold    = enable ? "\033[1m" : "";
+  }
+}
+
+/**
+  Write an overrunning buffer and the constraints blamed for its overrun.
+*/
+static void WriteOverrun(ostream& out, const Buffer& buffer, const vector<string>& blame) {
+  out << Colors::Red << buffer.getReadableName() << Colors::Normal << " " <<
+      buffer.getSourceLocation() << endl;
+  string lastLine = "";
+  for (size_t i = 0; i < blame.size(); ++i) {
+    if (blame[i] != lastLine) {
+      out << "  - " << blame[i] << endl;
+      lastLine = blame[i];
+    }
+  }
+}
+
+/**
+  Collects the overruns for the report. Every verdict is also written to the -results file as soon
+  as it is known, and with -stream every overrun is reported at once.
+*/
+class ReportSink : public ResultSink {
+  ostream* stream_;
+  ostream* results_;
+
+ public:
+  map<Buffer, vector<string> > unsafe_;
+
+  ReportSink(ostream* stream, ostream* results) : stream_(stream), results_(results) {}
+
+  virtual void Result(const Buffer& buffer, bool unsafe, const vector<string>& blame) {
+    if (unsafe) {
+      unsafe_[buffer] = blame;
+      if (stream_ != NULL) {
+        WriteOverrun(*stream_, buffer, blame);
+      }
+    }
+    if (results_ != NULL) {
+      *results_ << "{\"buffer\": " << JsonString(buffer.getReadableName()) << ", \"location\": "
+                << JsonString(buffer.getSourceLocation()) << ", \"overrun\": "
+                << (unsafe ? "true" : "false");
+      if (Blame && unsafe) {
+        *results_ << ", \"blame\": [";
+        for (size_t i = 0; i < blame.size(); ++i) {
+          *results_ << (i == 0 ? "" : ", ") << JsonString(blame[i]);
+        }
+        *results_ << "]";
+      }
+      // Flushed, for readers which follow the file.
+      *results_ << "}" << endl;
+    }
+  }
+};
+
+
+Analyzer::Analyzer(bool memoryCache) : constraintProblem_(NULL), constraintGenerator_(NULL),
+                                       cache_(NULL), results_(NULL) {
+  if (LogFile != "") {
+    ofstream* logfile = new ofstream();
+    logfile->open(LogFile.c_str());
+    log::Level level;
+    if (!log::parseLevel(LogLevel, &level)) {
+      cerr << "unknown log level " << LogLevel.c_str() << ", using trace" << endl;
+      level = log::Trace;
+    }
+    log::set(*logfile, level);
+  }
+  if (ProfileFile != "") {
+    Profiler::Enable();
+  }
+  LinearProblem::SetColdStart(NoWarmStart);
+  LinearProblem::SetBatchRepair(!SingleIIS);
+  safeFunctions_ = SplitString(SafeFunctions, ',');
+  unsafeFunctions_ = SplitString(UnsafeFunctions, ',');
+  models_ = ModelTable::Libc();
+  stringstream models(Models);
+  string path;
+  while (getline(models, path, ',')) {
+    string error;
+    if (!path.empty() && !models_.Load(path, &error)) {
+      cerr << error << endl;
+    }
+  }
+  if (ResultsFile != "") {
+    results_ = new ofstream(ResultsFile.c_str());
+  }
+  if (CacheDir != "" || memoryCache) {
+    cache_ = new ConstraintCache(CacheDir, memoryCache);
+  }
+}
+
+Analyzer::~Analyzer() {
+  delete constraintGenerator_;
+  delete constraintProblem_;
+  delete cache_;
+  delete results_;
+}
+
+void Analyzer::Generate(const Module& M) {
+  BeginModule(M);
+  for (Module::const_iterator it = M.begin(); it != M.end(); ++it) {
+    const Function *F = it;
+    VisitFunction(F);
+  }
+  EndModule();
+}
+
+void Analyzer::BeginModule(const Module& M) {
+  ProfileScope scope("generation");
+  delete constraintProblem_;
+  constraintProblem_ = new ConstraintProblem(OutputGlpk, Jobs, !NoGraphSolver, !NoPresolve,
+                                             !NoSummaries);
+  delete constraintGenerator_;
+  constraintGenerator_ = new ConstraintGenerator(*constraintProblem_, IgnoreLiterals,
+                                                 safeFunctions_, unsafeFunctions_);
+  constraintGenerator_->SetCache(cache_);
+  constraintGenerator_->SetModels(&models_);
+
+  for (Module::const_global_iterator it = M.global_begin(); it != M.global_end(); ++it) {
+    const GlobalValue *g = it;
+    constraintGenerator_->VisitGlobal(g);
+  }
+}
+
+void Analyzer::VisitFunction(const Function* F) {
+  ProfileScope scope("generation");
+  constraintGenerator_->VisitFunction(F);
+}
+
+void Analyzer::EndModule() {
+  ProfileScope scope("generation");
+  if (!NoPointerAnalysis) {
+    ProfileScope scope("AnalyzePointers");
+    constraintGenerator_->AnalyzePointers();
+  }
+  delete constraintGenerator_;
+  constraintGenerator_ = NULL;
+  // Also binds the call sites of functions without a summary to the functions' parameters.
+  constraintProblem_->Summarize();
+  LocationTable::ClearNodes();
+}
+
+void Analyzer::Report(ostream& out, bool colors) {
+  Colors::Setup(colors);
+  if (constraintProblem_->BuffersCount() == 0) {
+    out << "no buffers detected" << endl;
+    out << SEPARATOR << endl;
+    out << SEPARATOR << endl;
+    out << SEPARATOR << endl;
+    Forget();
+    return;
+  }
+  LOG_INFO << "Constraint solver output - " << endl;
+  ReportSink sink(Stream ? &out : NULL, results_);
+  {
+    ProfileScope scope(Blame ? "SolveAndBlame" : "Solve");
+    constraintProblem_->Solve(&sink, Blame);
+  }
+  vector<Buffer> unsafeBuffers;
+  for (map<Buffer, vector<string> >::iterator it = sink.unsafe_.begin(); it != sink.unsafe_.end();
+       ++it) {
+    unsafeBuffers.push_back(it->first);
+  }
+  out << Colors::Bold << "boa" << Colors::Normal << " found "
+      << constraintProblem_->BuffersCount() << " buffers. ";
+  if (unsafeBuffers.empty()) {
+    out << endl << Colors::Green << "No overruns detected" << Colors::Normal << "." << endl;
+    out << SEPARATOR << endl;
+    out << SEPARATOR << endl;
+    out << SEPARATOR << endl;
+  } else {
+    out << Colors::Red << unsafeBuffers.size() << " possible buffer overruns found"
+        << Colors::Normal << "." << endl;
+    out << SEPARATOR << endl;
+    if (Blame) {
+      if (Verbose) {
+        out << Colors::Bold << "Blames section" << Colors::Normal << " Each of the overrunning "
+               "buffers appear here with a small list of constraints which cause an overrun in "
+               "this buffer. A buffer is described by its name and the source location where it is "
+               "defined, a constraint consist of a brief desctiption and the source line where "
+               "it originates." << endl << endl;
+      }
+      for (map<Buffer, vector<string> >::iterator it = sink.unsafe_.begin();
+           it != sink.unsafe_.end();
+           ++it) {
+        WriteOverrun(out, it->first, it->second);
+      }
+    }
+    out << SEPARATOR << endl;
+    if (Verbose) {
+      out << Colors::Bold << "Buffers section" << Colors::Normal << " Each of the overrunning "
+             "buffers appear here, one in each line. A buffer is described by its name and the "
+             "source location where it is defined" << endl << endl;
+    }
+    for (vector<Buffer>::iterator buff = unsafeBuffers.begin();
+         buff != unsafeBuffers.end();
+         ++buff) {
+      out << Colors::Red << buff->getReadableName() << Colors::Normal << " " <<
+              buff->getSourceLocation() << endl;
+    }
+    out << SEPARATOR << endl;
+  }
+  Forget();
+}
+
+void Analyzer::Forget() {
+  delete constraintProblem_;
+  constraintProblem_ = NULL;
+  VarTable::Clear();
+}
+
+// Static.
+void Analyzer::WriteProfile() {
+  if (ProfileFile != "") {
+    ofstream profile(ProfileFile.c_str());
+    Profiler::WriteJson(profile);
+  }
+}
+
+}  // namespace boa
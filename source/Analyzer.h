@@ -0,0 +1,86 @@
+#ifndef __BOA_ANALYZER_H
+#define __BOA_ANALYZER_H /* */
+
+#include "llvm/Module.h"
+
+#include <ostream>
+#include <set>
+#include <string>
+
+#include "ConstraintCache.h"
+#include "ConstraintProblem.h"
+#include "ModelTable.h"
+
+using std::ostream;
+using std::set;
+using std::string;
+
+using namespace llvm;
+
+namespace boa {
+
+class ConstraintGenerator;
+
+/**
+  The boa analysis of llvm modules - generate the constraints of a module, solve them and report
+  the overrunning buffers.
+
+  The analysis is configured by the command line flags defined in Analyzer.cpp, which every tool
+  linking it accepts - the opt pass (boa.cpp) and the boa daemon (boad.cpp). One analyzer may
+  analyze many modules one after the other, the constraint cache is shared by all of them.
+*/
+class Analyzer {
+  ConstraintProblem* constraintProblem_;
+  ConstraintGenerator* constraintGenerator_;
+  set<string> safeFunctions_, unsafeFunctions_;
+  // The libc models and the -models files.
+  ModelTable models_;
+  ConstraintCache* cache_;
+  // The -results file.
+  ostream* results_;
+
+  /**
+    Forget the problem of the module analyzed last, and the variables of its nodes. Interned strings
+    and locations are kept for the next module.
+  */
+  void Forget();
+
+ public:
+  /**
+    memoryCache keeps the constraints of every function generated so far in memory, so analyzing
+    another module with the same functions doesn't generate them again.
+  */
+  explicit Analyzer(bool memoryCache = false);
+
+  ~Analyzer();
+
+  /**
+    Generate the constraints of module M. Once generated, the problem refers to the nodes of M
+    only as names of variables and buffers, M may be freed before Report.
+  */
+  void Generate(const Module& M);
+
+  /**
+    Generate the constraints of a module one function at a time - BeginModule visits its globals,
+    VisitFunction each function which is analyzed and EndModule completes the module. Generate
+    is the same as visiting all the functions of M.
+  */
+  void BeginModule(const Module& M);
+  void VisitFunction(const Function* F);
+  void EndModule();
+
+  /**
+    Solve the constraints of the module given to Generate, write the report to out and forget the
+    module. colors - use terminal colors in the report.
+  */
+  void Report(ostream& out, bool colors);
+
+  /**
+    Write the profile to the -profile file, if there is one.
+  */
+  static void WriteProfile();
+};
+
+}  // namespace boa
+
+#endif  // __BOA_ANALYZER_H
@@ -0,0 +1,27 @@
+#include "BlameInfo.h"
+
+namespace boa {
+
+StringPool BlameMessage::strings_;
+
+string BlameMessage::ToString() const {
+  if (argument_ == 0) {
+    return strings_.Get(text_);
+  }
+  return strings_.Get(text_) + " " + strings_.Get(argument_);
+}
+
+void BlameMessage::Clear() {
+  strings_.Clear();
+}
+
+string BlameInfo::ToString() const {
+  string message = message_.ToString();
+  string location = LocationTable::ToString(location_);
+  if (message.empty()) {
+    return "[" + location + "]";
+  }
+  return message + " [" + location + "]";
+}
+
+}  // namespace boa
@@ -0,0 +1,104 @@
+#ifndef __BOA_BLAMEINFO_H
+#define __BOA_BLAMEINFO_H /* */
+
+#include <stdint.h>
+
+#include <string>
+
+#include "LocationTable.h"
+#include "StringPool.h"
+
+using std::string;
+
+namespace boa {
+
+/**
+  The message of a blame - a fixed description of a kind of constraint, optionally followed by an
+  argument such as the name of a called function.
+
+  Both parts are interned. Fixed descriptions are interned once (function level statics, or the
+  blames of the library models), so generating a constraint only copies ids and builds no text.
+*/
+class BlameMessage {
+  uint32_t text_;
+  uint32_t argument_;
+
+  static StringPool strings_;
+
+ public:
+  BlameMessage() : text_(0), argument_(0) {}
+
+  explicit BlameMessage(const string& text) : text_(strings_.Intern(text)), argument_(0) {}
+
+  /**
+    message followed by argument.
+  */
+  BlameMessage(const BlameMessage& message, const string& argument) :
+    text_(message.text_), argument_(strings_.Intern(argument)) {}
+
+  const string& Text() const {
+    return strings_.Get(text_);
+  }
+
+  /**
+    The argument, empty if there is none.
+  */
+  const string& Argument() const {
+    return strings_.Get(argument_);
+  }
+
+  /**
+    The message text, in the form "text argument".
+  */
+  string ToString() const;
+
+  bool operator==(const BlameMessage& other) const {
+    return (text_ == other.text_) && (argument_ == other.argument_);
+  }
+
+  /**
+    Forget all interned messages. BlameMessages created before calling Clear (including static
+    ones) must not be used afterwards.
+  */
+  static void Clear();
+};
+
+/**
+  The blame of a single constraint - a short description of the constraint and the source location
+  it originates from.
+
+  The description is a BlameMessage and the location is a LocationTable handle, so a BlameInfo is
+  only a few ids. The blame text is rendered by ToString(), which should only be called when blame
+  output is requested.
+*/
+class BlameInfo {
+  BlameMessage message_;
+  Location location_;
+
+ public:
+  BlameInfo() {}
+
+  BlameInfo(const BlameMessage& message, Location location) :
+    message_(message), location_(location) {}
+
+  const BlameMessage& Message() const {
+    return message_;
+  }
+
+  Location GetLocation() const {
+    return location_;
+  }
+
+  /**
+    The blame text, in the form "message [location]"
+  */
+  string ToString() const;
+
+  bool operator==(const BlameInfo& other) const {
+    return (message_ == other.message_) && (location_ == other.location_);
+  }
+};
+
+}  // namespace boa
+
+#endif  // __BOA_BLAMEINFO_H
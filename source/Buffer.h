@@ -39,6 +39,10 @@ namespace boa {
       return readableName_;
     }
 
+    unsigned getOffset() const {
+      return offset_;
+    }
+
     string getSourceLocation() const {
       stringstream ss;
       ss << filename_;
@@ -1,7 +1,6 @@
 #ifndef __BOA_CONSTRAINT_H
 #define __BOA_CONSTRAINT_H /* */
 
-#include <cctype>
 #include <cstdlib>
 #include <iostream>
 #include <limits>
@@ -9,10 +8,10 @@
 #include <set>
 #include <string>
 
-#include <glpk.h>
-
+#include "BlameInfo.h"
 #include "Buffer.h"
 #include "Helpers.h"
+#include "VarTable.h"
 
 using std::cerr;
 using std::endl;
@@ -34,7 +33,7 @@ namespace boa {
   C >= aX + bY ...
 
   Where C is a constant (referred as "left"), a small letter (a, b...) is an
-  integer value ("num") and a capital letter (X, Y...) is a string name of variable.
+  integer value ("num") and a capital letter (X, Y...) is a variable id from the VarTable.
 */
 class Constraint {
  public:
@@ -49,24 +48,12 @@ class Constraint {
   enum Type {STRUCTURAL, ALIASING, NORMAL};
 
  private:
-  const static int MAX_SIZE = 100;
   double left_;
-  map<string, double> literals_;
-  string blame_;
+  map<VarId, double> literals_;
+  BlameInfo blame_;
   Type type_;
 
-
-  static string safeString(const string& str) {
-    string result = str.substr(0, 255);
-    for (size_t i = 0; i < result.length(); ++i) {
-      if (!isgraph(result[i])) {
-        result[i] = ' ';
-      }
-    }
-    return result;
-  }
-
-  void addLiteral(double num, string var) {
+  void addLiteral(double num, VarId var) {
     literals_[var] += num;
   }
 
@@ -78,30 +65,27 @@ class Constraint {
 
   class Expression {
     double val_;
-    map<string, double> vars_;
+    map<VarId, double> vars_;
 
    public:
     friend class Constraint;
     Expression() : val_(0.0) {}
     Expression(double value) : val_(value) {}
-    Expression(const string& var) : val_(0.0) { vars_[var] = 1.0; }
-
-    static const Expression NegInfinity;
-    static const Expression PosInfinity;
+    Expression(VarId var) : val_(0.0) { vars_[var] = 1.0; }
 
     void add(const Expression& expr) {
-      for (map<string, double>::const_iterator it = expr.vars_.begin();
+      for (map<VarId, double>::const_iterator it = expr.vars_.begin();
            it != expr.vars_.end();
            ++it) {
         add(it->first, it->second);
       }
       add(expr.val_);
     }
-    void add(const string& var, double num = 1.0) { vars_[var] += num; }
+    void add(VarId var, double num = 1.0) { vars_[var] += num; }
     void add(double num) {val_ += num;}
 
     void sub(const Expression& expr) {
-      for (map<string, double>::const_iterator it = expr.vars_.begin();
+      for (map<VarId, double>::const_iterator it = expr.vars_.begin();
            it != expr.vars_.end();
            ++it) {
         add(it->first, -it->second);
@@ -110,14 +94,14 @@ class Constraint {
     }
 
     void mul(double num) {
-      for (map<string, double>::iterator it = vars_.begin(); it != vars_.end(); ++it) {
+      for (map<VarId, double>::iterator it = vars_.begin(); it != vars_.end(); ++it) {
         it->second *= num;
       }
       val_ *= num;
     }
 
     void div(double num) {
-      for (map<string, double>::iterator it = vars_.begin(); it != vars_.end(); ++it) {
+      for (map<VarId, double>::iterator it = vars_.begin(); it != vars_.end(); ++it) {
         it->second /= num;
       }
       val_ /= num;
@@ -127,7 +111,7 @@ class Constraint {
       Does the expression contain only a free element (no literals)?
     */
     bool IsConst() const {
-      for (map<string, double>::const_iterator it = vars_.begin(); it != vars_.end(); ++it) {
+      for (map<VarId, double>::const_iterator it = vars_.begin(); it != vars_.end(); ++it) {
         if (it->second != 0) {
           return false;
         }
@@ -145,9 +129,9 @@ class Constraint {
 
     string toString() const {
       string s;
-      for (map<string, double>::const_iterator it = vars_.begin(); it != vars_.end(); ++it) {
+      for (map<VarId, double>::const_iterator it = vars_.begin(); it != vars_.end(); ++it) {
         if ((!s.empty()) && (it->second >= 0)) s += "+ ";
-        s += Helpers::DoubleToString(it->second) + "*" + it->first + " ";
+        s += Helpers::DoubleToString(it->second) + "*" + VarTable::Name(it->first) + " ";
       }
       if (s.empty() || (val_ != 0)) {
         if ((!s.empty()) && (val_ >= 0)) s += "+ ";
@@ -157,13 +141,12 @@ class Constraint {
     }
   };
 
-  Constraint() : left_(0.0), blame_("[]"), type_(NORMAL) {}
-  Constraint(const string &blame, const string &location) : left_(0.0), blame_(blame), type_(NORMAL) {
-    EnforceBlameLocation(blame);
-  }
+  Constraint() : left_(0.0), type_(NORMAL) {}
+  Constraint(const BlameMessage &blame, Location location) : left_(0.0), blame_(blame, location),
+                                                            type_(NORMAL) {}
 
   Constraint(const Expression &varExpr, const Expression &valueExpr,
-             VarLiteral::ExpressionDir direction) : left_(0.0), blame_("[]") {
+             VarLiteral::ExpressionDir direction) : left_(0.0) {
   switch (direction) {
     case VarLiteral::MAX:
       addBig(varExpr);
@@ -176,13 +159,8 @@ class Constraint {
     }
   }
 
-  void SetBlame(const string &blame) {
-    EnforceBlameLocation(blame);
-    blame_ = blame;
-  }
-
-  void SetBlame(const string &blame, const string &location, Type T = NORMAL) {
-    blame_ = blame + " [" + location + "]";
+  void SetBlame(const BlameMessage &blame, Location location, Type T = NORMAL) {
+    blame_ = BlameInfo(blame, location);
     type_ = T;
   }
 
@@ -190,12 +168,20 @@ class Constraint {
     return type_;
   }
 
-  string Blame() {
+  double Left() const {
+    return left_;
+  }
+
+  const map<VarId, double>& Literals() const {
+    return literals_;
+  }
+
+  const BlameInfo& Blame() const {
     return blame_;
   }
 
   void addBig(const Expression& expr) {
-    for (map<string, double>::const_iterator it = expr.vars_.begin();
+    for (map<VarId, double>::const_iterator it = expr.vars_.begin();
          it != expr.vars_.end();
          ++it) {
       addBig(it->first, it->second);
@@ -203,7 +189,7 @@ class Constraint {
     addBig(expr.val_);
   }
 
-  void addBig(const string& var, double num = 1.0) {
+  void addBig(VarId var, double num = 1.0) {
     addLiteral(-num, var);
   }
 
@@ -212,7 +198,7 @@ class Constraint {
   }
 
   void addSmall(const Expression& expr) {
-    for (map<string, double>::const_iterator it = expr.vars_.begin();
+    for (map<VarId, double>::const_iterator it = expr.vars_.begin();
          it != expr.vars_.end();
          ++it) {
       addSmall(it->first, it->second);
@@ -220,7 +206,7 @@ class Constraint {
     addSmall(expr.val_);
   }
 
-  void addSmall(const string& var, double num = 1.0) {
+  void addSmall(VarId var, double num = 1.0) {
     addLiteral(num, var);
   }
 
@@ -233,36 +219,9 @@ class Constraint {
    literals_.clear();
   }
 
-  void GetVars(set<string>& vars) const {
-    for (map<string, double>::const_iterator it = literals_.begin(); it != literals_.end(); ++it) {
-      vars.insert(it->first);
-    }
-  }
-
-  void AddToLPP(glp_prob *lp, int row, map<string, int>& colNumbers) const {
-    int indices[MAX_SIZE + 1];
-    double values[MAX_SIZE + 1];
-
-    int count = 1;
-    for (map<string, double>::const_iterator it = literals_.begin();
-         it != literals_.end();
-         ++it, ++count) {
-      indices[count] = colNumbers[it->first];
-      values[count] = it->second;
-    }
-    glp_set_row_bnds(lp, row, GLP_UP, 0.0, left_);
-    glp_set_mat_row(lp, row, literals_.size(), indices, values);
-    glp_set_row_name(lp, row, safeString(blame_).c_str());
-  }
-
  private:
-
-  static void EnforceBlameLocation(const string& blame) {
-    if (blame.find('[') == string::npos || blame.find(']') == string::npos) {
-      cerr << "Invalid blame string " << blame << endl;
-      exit(1);
-    }
-  }
+  // Rows are copied into the compact store.
+  friend class ConstraintStore;
 
   // Enable white-box inspection by the unit tests.
   friend class MockConstraintProblem;
@@ -0,0 +1,141 @@
+#include "ConstraintCache.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#include "log.h"
+
+using std::endl;
+using std::ifstream;
+using std::istreambuf_iterator;
+using std::ofstream;
+using std::stringstream;
+
+namespace boa {
+
+void ConstraintCache::Writer::PutInt(uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    data_ += static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+}
+
+void ConstraintCache::Writer::PutDouble(double value) {
+  // Entries are only read back on the machine that wrote them, the native layout is enough.
+  data_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void ConstraintCache::Writer::PutString(const string& value) {
+  PutInt(value.size());
+  data_ += value;
+}
+
+bool ConstraintCache::Reader::Read(void* to, size_t size) {
+  if (!ok_ || data_.size() - pos_ < size) {
+    ok_ = false;
+    return false;
+  }
+  memcpy(to, data_.data() + pos_, size);
+  pos_ += size;
+  return true;
+}
+
+bool ConstraintCache::Reader::GetInt(uint32_t* value) {
+  unsigned char bytes[4];
+  if (!Read(bytes, sizeof(bytes))) {
+    return false;
+  }
+  *value = 0;
+  for (int i = 3; i >= 0; --i) {
+    *value = (*value << 8) | bytes[i];
+  }
+  return true;
+}
+
+bool ConstraintCache::Reader::GetDouble(double* value) {
+  return Read(value, sizeof(*value));
+}
+
+bool ConstraintCache::Reader::GetString(string* value) {
+  uint32_t size;
+  if (!GetInt(&size) || data_.size() - pos_ < size) {
+    ok_ = false;
+    return false;
+  }
+  value->assign(data_, pos_, size);
+  pos_ += size;
+  return true;
+}
+
+ConstraintCache::ConstraintCache(const string& dir, bool memory) :
+    dir_(dir), memory_(memory || dir.empty()) {
+  if (!dir.empty() && mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+    LOG_ERROR << "Can't create cache directory " << dir << " - " << strerror(errno) << endl;
+  }
+}
+
+string ConstraintCache::Path(uint64_t key) const {
+  char name[17];
+  snprintf(name, sizeof(name), "%08x%08x", static_cast<unsigned>(key >> 32),
+           static_cast<unsigned>(key & 0xffffffff));
+  return dir_ + "/" + name;
+}
+
+bool ConstraintCache::Load(uint64_t key, string* data) const {
+  if (memory_) {
+    map<uint64_t, string>::const_iterator it = entries_.find(key);
+    if (it != entries_.end()) {
+      *data = it->second;
+      return true;
+    }
+  }
+  if (dir_.empty()) {
+    return false;
+  }
+  ifstream in(Path(key).c_str(), std::ios::in | std::ios::binary);
+  if (!in) {
+    return false;
+  }
+  data->assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+  if (in.bad()) {
+    return false;
+  }
+  if (memory_) {
+    entries_[key] = *data;
+  }
+  return true;
+}
+
+void ConstraintCache::Store(uint64_t key, const string& data) const {
+  if (memory_) {
+    entries_[key] = data;
+  }
+  if (dir_.empty()) {
+    return;
+  }
+  stringstream tmp;
+  tmp << Path(key) << ".tmp." << getpid();
+  {
+    ofstream out(tmp.str().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    out.write(data.data(), data.size());
+    if (!out) {
+      LOG_ERROR << "Can't write cache entry " << tmp.str() << endl;
+      out.close();
+      unlink(tmp.str().c_str());
+      return;
+    }
+  }
+  if (rename(tmp.str().c_str(), Path(key).c_str()) != 0) {
+    LOG_ERROR << "Can't write cache entry " << Path(key) << " - " << strerror(errno) << endl;
+    unlink(tmp.str().c_str());
+  }
+}
+
+}  // namespace boa
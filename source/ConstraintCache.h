@@ -0,0 +1,93 @@
+#ifndef __BOA_CONSTRAINTCACHE_H
+#define __BOA_CONSTRAINTCACHE_H /* */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <string>
+
+using std::map;
+using std::string;
+
+namespace boa {
+
+/**
+  On disk cache of the constraints generated for single functions.
+
+  Every entry is a file in the cache directory named by its 64 bit key (a hash of the function's IR
+  and of the generator options, see ConstraintGenerator::VisitFunction). The content is an opaque
+  binary record, written with a Writer and read back with a Reader. Entries are written to a
+  temporary file and renamed, so concurrent runs sharing a directory never see a partial entry.
+
+  A process which analyzes many modules (see boad.cpp) also keeps the entries in memory.
+*/
+class ConstraintCache {
+ public:
+  /**
+    Sequential binary encoding of a record.
+  */
+  class Writer {
+    string data_;
+
+   public:
+    void PutInt(uint32_t value);
+    void PutDouble(double value);
+    void PutString(const string& value);
+
+    const string& Data() const {
+      return data_;
+    }
+  };
+
+  /**
+    Decoding of a Writer's record. Reading beyond the end of the record fails, and every later
+    read fails too - check Ok() (or the return values) once the record was read.
+  */
+  class Reader {
+    const string& data_;
+    size_t pos_;
+    bool ok_;
+
+    bool Read(void* to, size_t size);
+
+   public:
+    explicit Reader(const string& data) : data_(data), pos_(0), ok_(true) {}
+
+    bool GetInt(uint32_t* value /* out */);
+    bool GetDouble(double* value /* out */);
+    bool GetString(string* value /* out */);
+
+    bool Ok() const {
+      return ok_;
+    }
+
+    bool AtEnd() const {
+      return pos_ == data_.size();
+    }
+  };
+
+  /**
+    Cache in directory dir, which is created if needed. An empty dir is a cache which is only kept
+    in memory. With memory, entries are also kept in memory once loaded or stored.
+  */
+  explicit ConstraintCache(const string& dir, bool memory = false);
+
+  /**
+    Read the record of key. Return false if there is none.
+  */
+  bool Load(uint64_t key, string* data /* out */) const;
+
+  void Store(uint64_t key, const string& data) const;
+
+ private:
+  string dir_;
+  bool memory_;
+  mutable map<uint64_t, string> entries_;
+
+  string Path(uint64_t key) const;
+};
+
+}  // namespace boa
+
+#endif  // __BOA_CONSTRAINTCACHE_H
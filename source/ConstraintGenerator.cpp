@@ -9,10 +9,14 @@
 #include "LinearProblem.h"
 #include "Pointer.h"
 #include "PointerAnalyzer.h"
+#include "Profiler.h"
 
 #include "llvm/Constants.h"
 #include "llvm/LLVMContext.h"
 #include "llvm/User.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <ctype.h>
 
 using std::pair;
 using std::stringstream;
@@ -27,29 +31,534 @@ static void swap(void* a, void* b) {
   b = temp;
 }
 
-void ConstraintGenerator::AddBuffer(const Buffer& buf, const string &location, bool literal) {
+// Changes whenever the generated constraints or the record format change.
+static const char CACHE_VERSION[] = "boa constraint cache 5";
+
+// Operations of a function's cache record.
+enum RecordOp {
+  RECORD_CONSTRAINT,
+  RECORD_UNBOUNDED,
+  RECORD_BUFFER,
+  RECORD_POINTS_TO,
+  RECORD_UNKNOWN_POINTER,
+  RECORD_CALL_SITE
+};
+
+/**
+  The llvm nodes a function's constraints may refer to - the function, its arguments, its
+  instructions, the uses of their operands, the operands themselves (including the operands of
+  constant expressions) and the parameters of the functions it calls. The nodes are numbered in
+  the order of the function's IR, so the same IR gives the same numbers in every run.
+*/
+class FunctionNodes {
+  vector<const void*> nodes_;
+  map<const void*, uint32_t> refs_;
+
+  bool Add(const void* node) {
+    if (!refs_.insert(std::make_pair(node, nodes_.size())).second) {
+      return false;
+    }
+    nodes_.push_back(node);
+    return true;
+  }
+
+  void AddValue(const Value* value) {
+    if (!Add(value)) {
+      return;
+    }
+    if (const ConstantExpr* expr = dyn_cast<const ConstantExpr>(value)) {
+      for (unsigned i = 0; i < expr->getNumOperands(); ++i) {
+        AddValue(expr->getOperand(i));
+      }
+    }
+  }
+
+ public:
+  explicit FunctionNodes(const Function* F) {
+    Add(F);
+    for (Function::const_arg_iterator it = F->arg_begin(); it != F->arg_end(); ++it) {
+      const Argument* arg = it;
+      Add(arg);
+    }
+    for (const_inst_iterator ii = inst_begin(F); ii != inst_end(F); ++ii) {
+      const Instruction* I = &(*ii);
+      Add(I);
+      for (unsigned i = 0; i < I->getNumOperands(); ++i) {
+        Add(&I->getOperandUse(i));
+        AddValue(I->getOperand(i));
+      }
+      // Arguments are passed to the parameters of the called function.
+      if (const CallInst* call = dyn_cast<const CallInst>(I)) {
+        if (const Function* callee = call->getCalledFunction()) {
+          for (Function::const_arg_iterator it = callee->arg_begin(); it != callee->arg_end();
+               ++it) {
+            const Argument* arg = it;
+            Add(arg);
+          }
+        }
+      }
+    }
+  }
+
+  bool Find(const void* node, uint32_t* ref /* out */) const {
+    map<const void*, uint32_t>::const_iterator it = refs_.find(node);
+    if (it == refs_.end()) {
+      *ref = ~0u;
+      return false;
+    }
+    *ref = it->second;
+    return true;
+  }
+
+  bool Get(uint32_t ref, const void** node /* out */) const {
+    if (ref >= nodes_.size()) {
+      return false;
+    }
+    *node = nodes_[ref];
+    return true;
+  }
+};
+
+void ConstraintGenerator::AddBuffer(const Buffer& buf, Location location, bool literal) {
+  static const BlameMessage blame("Buffer Addition");
   if (!(IgnoreLiterals_ && literal)) {
     // add buffer to problem unless it is a string literal and we ignore literals
-    cp_.AddBuffer(buf);
-    buffers_.insert(buf);
+    RegisterBuffer(buf);
   }
 
   GenerateConstraint(buf.NameExpression(VarLiteral::MAX, VarLiteral::LEN_READ),
                      buf.NameExpression(VarLiteral::MAX, VarLiteral::USED),
-                     VarLiteral::MAX, "Buffer Addition", location, Constraint::STRUCTURAL);
+                     VarLiteral::MAX, blame, location, Constraint::STRUCTURAL);
   GenerateConstraint(buf.NameExpression(VarLiteral::MAX, VarLiteral::USED),
                      buf.NameExpression(VarLiteral::MAX, VarLiteral::LEN_WRITE),
-                     VarLiteral::MAX, "Buffer Addition", location, Constraint::STRUCTURAL);
+                     VarLiteral::MAX, blame, location, Constraint::STRUCTURAL);
 
   GenerateConstraint(buf.NameExpression(VarLiteral::MIN, VarLiteral::LEN_READ),
                      buf.NameExpression(VarLiteral::MIN, VarLiteral::USED),
-                     VarLiteral::MIN, "Buffer Addition", location, Constraint::STRUCTURAL);
+                     VarLiteral::MIN, blame, location, Constraint::STRUCTURAL);
   GenerateConstraint(buf.NameExpression(VarLiteral::MIN, VarLiteral::USED),
                      buf.NameExpression(VarLiteral::MIN, VarLiteral::LEN_WRITE),
-                     VarLiteral::MIN, "Buffer Addition", location, Constraint::STRUCTURAL);
+                     VarLiteral::MIN, blame, location, Constraint::STRUCTURAL);
+}
+
+void ConstraintGenerator::RegisterBuffer(const Buffer& buf) {
+  cp_.AddBuffer(buf);
+  if (buffers_.insert(buf).second) {
+    pointerAnalyzer_.AddBuffer(buf);
+  }
+  if (record_) {
+    record_->PutInt(RECORD_BUFFER);
+    RecordNode(buf.Node());
+    record_->PutInt(buf.IsTmp());
+    record_->PutInt(buf.getOffset());
+    record_->PutString(buf.getReadableName());
+    record_->PutString(buf.getSourceLocation());
+  }
+}
+
+void ConstraintGenerator::AddConstraint(const Constraint& constraint) {
+  cp_.AddConstraint(constraint);
+  if (record_) {
+    record_->PutInt(RECORD_CONSTRAINT);
+    record_->PutDouble(constraint.Left());
+    record_->PutInt(constraint.GetType());
+    RecordBlame(constraint.Blame());
+    const map<VarId, double>& literals = constraint.Literals();
+    record_->PutInt(literals.size());
+    for (map<VarId, double>::const_iterator it = literals.begin(); it != literals.end(); ++it) {
+      RecordVar(it->first);
+      record_->PutDouble(it->second);
+    }
+  }
+}
+
+void ConstraintGenerator::AddUnbounded(VarId var, const BlameInfo& blame) {
+  cp_.AddUnbounded(var, blame);
+  if (record_) {
+    record_->PutInt(RECORD_UNBOUNDED);
+    RecordVar(var);
+    RecordBlame(blame);
+  }
+}
+
+void ConstraintGenerator::AddPointsTo(PointsTo statement, const VarLiteral& first,
+                                      const VarLiteral& second) {
+  switch (statement) {
+    case OBJECT:
+      pointerAnalyzer_.AddObject(first);
+      break;
+    case UNKNOWN:
+      pointerAnalyzer_.AddUnknown(first);
+      break;
+    case ESCAPE:
+      pointerAnalyzer_.AddEscape(first);
+      break;
+    case COPY:
+      pointerAnalyzer_.AddCopy(first, second);
+      break;
+    case LOAD:
+      pointerAnalyzer_.AddLoad(first, second);
+      break;
+    case STORE:
+      pointerAnalyzer_.AddStore(first, second);
+      break;
+  }
+  if (record_) {
+    record_->PutInt(RECORD_POINTS_TO);
+    record_->PutInt(statement);
+    RecordNode(first.Node());
+    record_->PutInt(first.IsTmp());
+    RecordNode(second.Node());
+    record_->PutInt(second.IsTmp());
+  }
+}
+
+void ConstraintGenerator::AddUnknownPointer(const Pointer& pointer) {
+  unknownPointers_.insert(pointer);
+  if (record_) {
+    record_->PutInt(RECORD_UNKNOWN_POINTER);
+    RecordNode(pointer.Node());
+  }
+}
+
+void ConstraintGenerator::AddCallSite(const Function* callee,
+                                      const map<const void*, const void*>& instances,
+                                      const BlameInfo& blame) {
+  cp_.AddCallSite(callee, instances, blame);
+  if (record_) {
+    record_->PutInt(RECORD_CALL_SITE);
+    RecordNode(callee);
+    record_->PutInt(instances.size());
+    for (map<const void*, const void*>::const_iterator it = instances.begin();
+         it != instances.end(); ++it) {
+      RecordNode(it->first);
+      RecordNode(it->second);
+    }
+    RecordBlame(blame);
+  }
+}
+
+void ConstraintGenerator::RecordNode(const void* node) {
+  uint32_t ref;
+  if (!nodes_->Find(node, &ref)) {
+    // A node outside of the function, such as a struct type.
+    cacheable_ = false;
+  }
+  record_->PutInt(ref);
+}
+
+void ConstraintGenerator::RecordVar(VarId var) {
+  RecordNode(VarTable::Node(var));
+  record_->PutInt(VarTable::IsTmp(var));
+  record_->PutInt(VarTable::Type(var));
+  record_->PutInt(VarTable::IsMax(var) ? VarLiteral::MAX : VarLiteral::MIN);
+}
+
+void ConstraintGenerator::RecordBlame(const BlameInfo& blame) {
+  string file;
+  unsigned line;
+  LocationTable::GetParts(blame.GetLocation(), &file, &line);
+  record_->PutString(blame.Message().Text());
+  record_->PutString(blame.Message().Argument());
+  record_->PutString(file);
+  record_->PutInt(line);
+}
+
+static bool ReadNode(ConstraintCache::Reader* reader, const FunctionNodes& nodes,
+                     const void** node /* out */) {
+  uint32_t ref;
+  return reader->GetInt(&ref) && nodes.Get(ref, node);
+}
+
+static bool ReadVarLiteral(ConstraintCache::Reader* reader, const FunctionNodes& nodes,
+                           Buffer* literal /* out */) {
+  const void* node;
+  uint32_t isTmp;
+  if (!ReadNode(reader, nodes, &node) || !reader->GetInt(&isTmp)) {
+    return false;
+  }
+  // Only the node of the literal matters, a Buffer is the concrete VarLiteral at hand.
+  *literal = Buffer(node, "", "", isTmp);
+  return true;
+}
+
+static bool ReadVar(ConstraintCache::Reader* reader, const FunctionNodes& nodes,
+                    VarId* var /* out */) {
+  const void* node;
+  uint32_t isTmp, type, dir;
+  if (!ReadNode(reader, nodes, &node) || !reader->GetInt(&isTmp) || !reader->GetInt(&type) ||
+      !reader->GetInt(&dir)) {
+    return false;
+  }
+  *var = VarTable::Intern(node, isTmp, static_cast<int>(type), dir);
+  return true;
+}
+
+static bool ReadBlame(ConstraintCache::Reader* reader, BlameMessage* message /* out */,
+                      Location* location /* out */) {
+  string text, argument, file;
+  uint32_t line;
+  if (!reader->GetString(&text) || !reader->GetString(&argument) || !reader->GetString(&file) ||
+      !reader->GetInt(&line)) {
+    return false;
+  }
+  *message = argument.empty() ? BlameMessage(text) : BlameMessage(BlameMessage(text), argument);
+  *location = LocationTable::FromFileLine(file, line);
+  return true;
+}
+
+bool ConstraintGenerator::Replay(const FunctionNodes& nodes, const string& record, bool apply) {
+  ConstraintCache::Reader reader(record);
+  while (!reader.AtEnd()) {
+    uint32_t op;
+    if (!reader.GetInt(&op)) {
+      return false;
+    }
+    switch (op) {
+      case RECORD_CONSTRAINT: {
+        double left, coef;
+        uint32_t type, size;
+        BlameMessage message;
+        Location location;
+        if (!reader.GetDouble(&left) || !reader.GetInt(&type) || type > Constraint::NORMAL ||
+            !ReadBlame(&reader, &message, &location) || !reader.GetInt(&size)) {
+          return false;
+        }
+        Constraint constraint;
+        constraint.addBig(left);
+        for (uint32_t i = 0; i < size; ++i) {
+          VarId var;
+          if (!ReadVar(&reader, nodes, &var) || !reader.GetDouble(&coef)) {
+            return false;
+          }
+          constraint.addSmall(var, coef);
+        }
+        constraint.SetBlame(message, location, static_cast<Constraint::Type>(type));
+        if (apply) {
+          AddConstraint(constraint);
+        }
+        break;
+      }
+      case RECORD_UNBOUNDED: {
+        VarId var;
+        BlameMessage message;
+        Location location;
+        if (!ReadVar(&reader, nodes, &var) || !ReadBlame(&reader, &message, &location)) {
+          return false;
+        }
+        if (apply) {
+          AddUnbounded(var, BlameInfo(message, location));
+        }
+        break;
+      }
+      case RECORD_BUFFER: {
+        const void* node;
+        uint32_t isTmp, offset;
+        string name, filename;
+        if (!ReadNode(&reader, nodes, &node) || !reader.GetInt(&isTmp) ||
+            !reader.GetInt(&offset) || !reader.GetString(&name) || !reader.GetString(&filename)) {
+          return false;
+        }
+        if (apply) {
+          RegisterBuffer(Buffer(node, name, filename, isTmp, offset));
+        }
+        break;
+      }
+      case RECORD_POINTS_TO: {
+        uint32_t statement;
+        Buffer first, second;
+        if (!reader.GetInt(&statement) || statement > STORE ||
+            !ReadVarLiteral(&reader, nodes, &first) || !ReadVarLiteral(&reader, nodes, &second)) {
+          return false;
+        }
+        if (apply) {
+          AddPointsTo(static_cast<PointsTo>(statement), first, second);
+        }
+        break;
+      }
+      case RECORD_UNKNOWN_POINTER: {
+        const void* node;
+        if (!ReadNode(&reader, nodes, &node)) {
+          return false;
+        }
+        if (apply) {
+          AddUnknownPointer(Pointer(static_cast<const Value*>(node)));
+        }
+        break;
+      }
+      case RECORD_CALL_SITE: {
+        const void* callee;
+        uint32_t size;
+        map<const void*, const void*> instances;
+        if (!ReadNode(&reader, nodes, &callee) || !reader.GetInt(&size)) {
+          return false;
+        }
+        for (uint32_t i = 0; i < size; ++i) {
+          const void *node, *instance;
+          if (!ReadNode(&reader, nodes, &node) || !ReadNode(&reader, nodes, &instance)) {
+            return false;
+          }
+          instances[node] = instance;
+        }
+        BlameMessage message;
+        Location location;
+        if (!ReadBlame(&reader, &message, &location)) {
+          return false;
+        }
+        if (apply) {
+          AddCallSite(static_cast<const Function*>(callee), instances,
+                      BlameInfo(message, location));
+        }
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+  return reader.Ok();
+}
+
+uint64_t ConstraintGenerator::CacheKey(const Function* F) {
+  stringstream key;
+  key << CACHE_VERSION << " " << IgnoreLiterals_ << " " << models_->Fingerprint();
+  for (set<string>::const_iterator it = safeFunctions_.begin(); it != safeFunctions_.end(); ++it) {
+    key << " safe " << *it;
+  }
+  for (set<string>::const_iterator it = unsafeFunctions_.begin(); it != unsafeFunctions_.end();
+       ++it) {
+    key << " unsafe " << *it;
+  }
+  key << "\n";
+
+  // Metadata ids depend on the rest of the module, the debug information the generator uses is
+  // added explicitly instead.
+  string ir;
+  raw_string_ostream out(ir);
+  F->print(out);
+  out.flush();
+  for (size_t i = 0; i < ir.size(); ++i) {
+    key << ir[i];
+    if (ir[i] == '!' && i > 0 && ir[i - 1] == ' ') {
+      while (i + 1 < ir.size() && isdigit(ir[i + 1])) {
+        ++i;
+      }
+    }
+  }
+
+  for (const_inst_iterator ii = inst_begin(F); ii != inst_end(F); ++ii) {
+    const Instruction* I = &(*ii);
+    key << LocationTable::ToString(GetInstructionLocation(I)) << "\n";
+    if (const DbgDeclareInst *D = dyn_cast<const DbgDeclareInst>(I)) {
+      const MDNode* variable = D->getVariable();
+      if (const MDString *name = dyn_cast_or_null<const MDString>(variable->getOperand(2))) {
+        key << name->getString().str();
+      }
+      if (const MDNode *node = dyn_cast_or_null<const MDNode>(variable->getOperand(3))) {
+        if (const MDString *file = dyn_cast_or_null<const MDString>(node->getOperand(1))) {
+          key << " " << file->getString().str();
+        }
+      }
+      key << "\n";
+    } else if (const CallInst *call = dyn_cast<const CallInst>(I)) {
+      // Calls of functions without a body are modeled differently.
+      if (const Function* callee = call->getCalledFunction()) {
+        key << callee->isDeclaration() << "\n";
+      }
+    }
+  }
+  return Helpers::Hash(key.str());
+}
+
+void ConstraintGenerator::VisitFunction(const Function *F) {
+  if (F->isDeclaration()) {
+    return;
+  }
+  vector<const void*> interface(1, F);
+  for (Function::const_arg_iterator it = F->arg_begin(); it != F->arg_end(); ++it) {
+    const Argument* arg = it;
+    interface.push_back(arg);
+  }
+  cp_.BeginFunction(F, interface);
+  if (!F->hasLocalLinkage() || F->hasAddressTaken()) {
+    // Callers the generator doesn't see (other modules, calls through pointers) may pass any
+    // pointer.
+    for (Function::const_arg_iterator it = F->arg_begin(); it != F->arg_end(); ++it) {
+      const Argument* arg = it;
+      if (arg->getType()->isPointerTy()) {
+        AddPointsTo(UNKNOWN, Pointer(arg));
+      }
+    }
+  }
+  if (cache_ == NULL) {
+    for (const_inst_iterator ii = inst_begin(F); ii != inst_end(F); ++ii) {
+      VisitInstruction(&(*ii), F);
+    }
+    cp_.EndFunction();
+    return;
+  }
+
+  FunctionNodes nodes(F);
+  uint64_t key = CacheKey(F);
+  string record;
+  if (cache_->Load(key, &record) && Replay(nodes, record, false)) {
+    Replay(nodes, record, true);
+    Profiler::Count("cached functions", 1);
+  } else {
+    ConstraintCache::Writer writer;
+    nodes_ = &nodes;
+    record_ = &writer;
+    cacheable_ = true;
+    for (const_inst_iterator ii = inst_begin(F); ii != inst_end(F); ++ii) {
+      VisitInstruction(&(*ii), F);
+    }
+    nodes_ = NULL;
+    record_ = NULL;
+    if (cacheable_) {
+      cache_->Store(key, writer.Data());
+    } else {
+      LOG_DEBUG << "Constraints of " << F->getNameStr() << " can't be cached" << endl;
+    }
+    Profiler::Count("cache misses", 1);
+  }
+  cp_.EndFunction();
+}
+
+bool ConstraintGenerator::MayTouchBuffers(const Function *F) {
+  if (!F->getReturnType()->isVoidTy()) {
+    return true;
+  }
+  for (Function::const_arg_iterator it = F->arg_begin(); it != F->arg_end(); ++it) {
+    if (it->getType()->isPointerTy()) {
+      return true;
+    }
+  }
+  for (const_inst_iterator ii = inst_begin(F); ii != inst_end(F); ++ii) {
+    const Instruction* I = &(*ii);
+    if (I->getType()->isPointerTy()) {
+      return true;
+    }
+    // A call binds the callee's parameters, unless the callee is an intrinsic (e.g. dbg.value).
+    const Value* callee = NULL;
+    if (const CallInst* call = dyn_cast<const CallInst>(I)) {
+      callee = call->getCalledValue();
+      const Function* f = dyn_cast<const Function>(callee);
+      if (f == NULL || !f->isIntrinsic()) {
+        return true;
+      }
+    }
+    for (User::const_op_iterator op = I->op_begin(); op != I->op_end(); ++op) {
+      if (*op != callee && (*op)->getType()->isPointerTy()) {
+        return true;
+      }
+    }
+  }
+  return false;
 }
 
 void ConstraintGenerator::VisitInstruction(const Instruction *I, const Function *F) {
+  static const BlameMessage intExtend("Int sign extend"), floatExtend("Float sign extend"),
+      floatToInt("Float to int cast"), uintToFloat("Uint to float cast"),
+      intToFloat("Int to float cast"), arbitraryCast("Arbitrary cast");
   if (const DbgDeclareInst *D = dyn_cast<const DbgDeclareInst>(I)) {
     SaveDbgDeclare(D);
     return;
@@ -120,25 +629,26 @@ void ConstraintGenerator::VisitInstruction(const Instruction *I, const Function
   case Instruction::Trunc:
   case Instruction::ZExt:
   case Instruction::SExt:
-    GenerateCastConstraint(dyn_cast<const CastInst>(I), "Int sign extend");
+    GenerateCastConstraint(dyn_cast<const CastInst>(I), intExtend);
 //  case Instruction::FPToUI:
   case Instruction::FPExt:
-    GenerateCastConstraint(dyn_cast<const CastInst>(I), "Float sign extend");
+    GenerateCastConstraint(dyn_cast<const CastInst>(I), floatExtend);
     break;
   case Instruction::FPToSI:
-    GenerateCastConstraint(dyn_cast<const CastInst>(I), "Float to int cast");
+    GenerateCastConstraint(dyn_cast<const CastInst>(I), floatToInt);
     break;
   case Instruction::UIToFP:
-    GenerateCastConstraint(dyn_cast<const CastInst>(I), "Uint to float cast");
+    GenerateCastConstraint(dyn_cast<const CastInst>(I), uintToFloat);
     break;
   case Instruction::SIToFP:
-    GenerateCastConstraint(dyn_cast<const CastInst>(I), "Int to float cast");
+    GenerateCastConstraint(dyn_cast<const CastInst>(I), intToFloat);
     break;
 
   // Exploiting case fall-through.
   case Instruction::IntToPtr:
+    AddPointsTo(UNKNOWN, Pointer(I));
   case Instruction::PtrToInt:
-    GenerateCastConstraint(dyn_cast<const CastInst>(I), "Arbitrary cast");
+    GenerateCastConstraint(dyn_cast<const CastInst>(I), arbitraryCast);
     break;
 
   case Instruction::BitCast:
@@ -174,7 +684,7 @@ void ConstraintGenerator::VisitInstruction(const Instruction *I, const Function
 //  case Instruction::InsertValue:
 
   default :
-    LOG << "unhandled instruction " << I->getOpcodeName() << endl;
+    LOG_DEBUG << "unhandled instruction " << I->getOpcodeName() << endl;
     break;
   }
 }
@@ -185,10 +695,16 @@ void ConstraintGenerator::VisitGlobal(const GlobalValue *G) {
   if (const PointerType *p = dyn_cast<const PointerType>(t)) {
     t = p->getElementType();
   } else {
-    LOG << "can't handle global variable" << endl;
+    LOG_ERROR << "can't handle global variable" << endl;
     return;
   }
   if (const GlobalVariable *GV = dyn_cast<const GlobalVariable>(G)) {
+    if (GV->hasInitializer()) {
+      GenerateInitializerPointsTo(GV, GV->getInitializer());
+    } else {
+      // Defined in another module, which may store any pointer in it.
+      AddPointsTo(ESCAPE, Pointer(GV));
+    }
     if (const ArrayType *ar = dyn_cast<const ArrayType>(t)) {
       unsigned len = ar->getNumElements() - 1;
       string s;
@@ -203,55 +719,91 @@ void ConstraintGenerator::VisitGlobal(const GlobalValue *G) {
           Helpers::ReplaceInString(s, ']', "\\]");
           s = "string literal \"" + s + "\"";
           Buffer buf(G, s, "");
-          LOG << "Adding string literal. Len - " << len <<  " at " << (void*)G << endl;
-
-          GenerateAllocConstraint(G, ar, "(literal)");
-          GenerateConstraint(buf, len, VarLiteral::LEN_WRITE, VarLiteral::MAX, s, "(literal)");
-          GenerateConstraint(buf, len, VarLiteral::LEN_WRITE, VarLiteral::MIN, s, "(literal)");
-          AddBuffer(buf, "(literal)", true);
+          BlameMessage blame(s);
+          LOG_DEBUG << "Adding string literal. Len - " << len <<  " at " << (void*)G << endl;
+
+          Location literal = LocationTable::FromText("(literal)");
+          GenerateAllocConstraint(G, ar, literal);
+          GenerateConstraint(buf, len, VarLiteral::LEN_WRITE, VarLiteral::MAX, blame, literal);
+          GenerateConstraint(buf, len, VarLiteral::LEN_WRITE, VarLiteral::MIN, blame, literal);
+          AddBuffer(buf, literal, true);
           return;
         }
       }
       // Otherwise this is a global array
       s = GV->getNameStr();
       Buffer buf1(G, s, "");
-      GenerateAllocConstraint(G, ar, "Global Array");
-      AddBuffer(buf1, "Global Array");
+      Location globalArray = LocationTable::FromText("Global Array");
+      GenerateAllocConstraint(G, ar, globalArray);
+      AddBuffer(buf1, globalArray);
       return;
     }
+    // Not a buffer, but may hold pointers.
+    AddPointsTo(OBJECT, Pointer(GV));
     if (t->isIntegerTy()) {
+      static const BlameMessage blame("global int");
       Integer globalInt(GV);
-      GenerateGenericConstraint(globalInt, GV->getInitializer(), VarLiteral::USED,
-                                "global int", ""); //TODO: location
-      GeneratePointerDerefConstraint(GV, "");
+      GenerateGenericConstraint(globalInt, GV->getInitializer(), VarLiteral::USED, blame,
+                                Location()); //TODO: location
+      GeneratePointerDerefConstraint(GV, Location());
     }
   }
 }
 
+void ConstraintGenerator::GenerateInitializerPointsTo(const GlobalVariable* GV,
+                                                      const Constant* C) {
+  if (C->isNullValue() || isa<UndefValue>(C)) {
+    return;
+  }
+  if (isa<ConstantArray>(C) || isa<ConstantStruct>(C)) {
+    for (unsigned i = 0; i < C->getNumOperands(); ++i) {
+      GenerateInitializerPointsTo(GV, cast<Constant>(C->getOperand(i)));
+    }
+    return;
+  }
+  if (!C->getType()->isPointerTy()) {
+    return;
+  }
+  if (const ConstantExpr* expr = dyn_cast<const ConstantExpr>(C)) {
+    if (expr->getOpcode() == Instruction::GetElementPtr) {
+      AddPointsTo(STORE, Pointer(GV), makePointer(expr));
+    } else if (expr->isCast() && expr->getOperand(0)->getType()->isPointerTy()) {
+      GenerateInitializerPointsTo(GV, cast<Constant>(expr->getOperand(0)));
+    } else {
+      // An integer cast to a pointer.
+      AddPointsTo(ESCAPE, Pointer(GV));
+    }
+    return;
+  }
+  AddPointsTo(STORE, Pointer(GV), Pointer(C));
+}
+
 void ConstraintGenerator::GenerateReturnConstraint(const ReturnInst* I, const Function *F) {
   if (I->getReturnValue()) { // non void
     if (F->getReturnType()->isPointerTy()) {
       Pointer from(makePointer(I->getReturnValue())), to(F);
-      GenerateBufferAliasConstraint(from, to, GetInstructionFilename(I));
+      GenerateBufferAliasConstraint(from, to, GetInstructionLocation(I));
     } else {
+      static const BlameMessage blame("return value");
       Integer intLiteral(F);
-      GenerateGenericConstraint(intLiteral, I->getReturnValue(), VarLiteral::USED, "return value",
-                                GetInstructionFilename(I));
+      GenerateGenericConstraint(intLiteral, I->getReturnValue(), VarLiteral::USED, blame,
+                                GetInstructionLocation(I));
     }
   }
 }
 
 void ConstraintGenerator::GenerateAndConstraint(const BinaryOperator* I) {
+  static const BlameMessage blame("bitwise and");
   Integer res(I);
-  GenerateGenericConstraint(res, I->getOperand(0), VarLiteral::USED, "bitwise and",
-                            GetInstructionFilename(I));
-  GenerateGenericConstraint(res, I->getOperand(1), VarLiteral::USED, "bitwise and",
-                            GetInstructionFilename(I));
+  GenerateGenericConstraint(res, I->getOperand(0), VarLiteral::USED, blame,
+                            GetInstructionLocation(I));
+  GenerateGenericConstraint(res, I->getOperand(1), VarLiteral::USED, blame,
+                            GetInstructionLocation(I));
 }
 
 
 void ConstraintGenerator::GenerateAddConstraint(const BinaryOperator* I) {
-  string blame = "Addition";
+  static const BlameMessage blame("Addition");
   Expression maxResult, minResult;
   maxResult.add(GenerateIntegerExpression(I->getOperand(0), VarLiteral::MAX));
   minResult.add(GenerateIntegerExpression(I->getOperand(0), VarLiteral::MIN));
@@ -260,14 +812,14 @@ void ConstraintGenerator::GenerateAddConstraint(const BinaryOperator* I) {
 
   Integer intLiteral(I);
   GenerateConstraint(intLiteral, maxResult, VarLiteral::USED, VarLiteral::MAX, blame,
-                     GetInstructionFilename(I));
+                     GetInstructionLocation(I));
   GenerateConstraint(intLiteral, minResult, VarLiteral::USED, VarLiteral::MIN, blame,
-                     GetInstructionFilename(I));
+                     GetInstructionLocation(I));
 }
 
 
 void ConstraintGenerator::GenerateSubConstraint(const BinaryOperator* I) {
-  string blame = "Subtraction";
+  static const BlameMessage blame("Subtraction");
   Expression maxResult, minResult;
   maxResult.add(GenerateIntegerExpression(I->getOperand(0), VarLiteral::MAX));
   minResult.add(GenerateIntegerExpression(I->getOperand(0), VarLiteral::MIN));
@@ -276,13 +828,13 @@ void ConstraintGenerator::GenerateSubConstraint(const BinaryOperator* I) {
 
   Integer intLiteral(I);
   GenerateConstraint(intLiteral, maxResult, VarLiteral::USED, VarLiteral::MAX, blame,
-                     GetInstructionFilename(I));
+                     GetInstructionLocation(I));
   GenerateConstraint(intLiteral, minResult, VarLiteral::USED, VarLiteral::MIN, blame,
-                     GetInstructionFilename(I));
+                     GetInstructionLocation(I));
 }
 
 void ConstraintGenerator::GenerateMulConstraint(const BinaryOperator* I) {
-  string blame = "Multiplication";
+  static const BlameMessage blame("Multiplication");
   Integer intLiteral(I);
   Expression operand0Max = GenerateIntegerExpression(I->getOperand(0), VarLiteral::MAX);
   Expression operand1Max = GenerateIntegerExpression(I->getOperand(1), VarLiteral::MAX);
@@ -301,7 +853,8 @@ void ConstraintGenerator::GenerateMulConstraint(const BinaryOperator* I) {
     minOperand = &operand0Min;
     maxOperand = &operand0Max;
   } else {
-    GenerateUnboundConstraint(intLiteral, "Unconst multiplication.", GetInstructionFilename(I));
+    static const BlameMessage unbound("Unconst multiplication.");
+    GenerateUnboundConstraint(intLiteral, unbound, GetInstructionLocation(I));
     return;
   }
   if (constOperand < 0.0) {
@@ -312,18 +865,19 @@ void ConstraintGenerator::GenerateMulConstraint(const BinaryOperator* I) {
   minOperand->mul(constOperand);
   maxOperand->mul(constOperand);
 
-  string loc = GetInstructionFilename(I);
+  Location loc = GetInstructionLocation(I);
 
   GenerateConstraint(intLiteral, *maxOperand, VarLiteral::USED, VarLiteral::MAX, blame, loc);
   GenerateConstraint(intLiteral, *minOperand, VarLiteral::USED, VarLiteral::MIN, blame, loc);
 }
 
 void ConstraintGenerator::GenerateDivConstraint(const BinaryOperator* I) {
-  string blame = "Division";
+  static const BlameMessage blame("Division");
   Integer intLiteral(I);
   Expression operand1 = GenerateIntegerExpression(I->getOperand(1), VarLiteral::MAX);
   if (!operand1.IsConst()) {
-    GenerateUnboundConstraint(intLiteral, "Non-const denominator.", GetInstructionFilename(I));
+    static const BlameMessage unbound("Non-const denominator.");
+    GenerateUnboundConstraint(intLiteral, unbound, GetInstructionLocation(I));
     return;
   }
   double constOperand = operand1.GetConst();
@@ -338,114 +892,122 @@ void ConstraintGenerator::GenerateDivConstraint(const BinaryOperator* I) {
     swap(&minOperand, &maxOperand);
   }
 
-  string loc = GetInstructionFilename(I);
+  Location loc = GetInstructionLocation(I);
 
   GenerateConstraint(intLiteral, maxOperand, VarLiteral::USED, VarLiteral::MAX, blame, loc);
   GenerateConstraint(intLiteral, minOperand, VarLiteral::USED, VarLiteral::MIN, blame, loc);
 }
 
-void ConstraintGenerator::GenerateCastConstraint(const CastInst* I, const string& blame) {
+void ConstraintGenerator::GenerateCastConstraint(const CastInst* I, const BlameMessage& blame) {
   Integer intLiteral(I);
   GenerateGenericConstraint(intLiteral, I->getOperand(0), VarLiteral::USED, blame,
-                            GetInstructionFilename(I));
+                            GetInstructionLocation(I));
 }
 
 void ConstraintGenerator::GenerateBitCastConstraint(const CastInst* I) {
   if (dyn_cast<const PointerType>(I->getDestTy())) {
-    string loc = GetInstructionFilename(I);
+    Location loc = GetInstructionLocation(I);
     Pointer pTo(I), pFrom(makePointer(I->getOperand(0)));
     GenerateBufferAliasConstraint(pFrom, pTo, loc);
-    GenerateCastConstraint(I, "Bitcast Constraint");
+    static const BlameMessage blame("Bitcast Constraint");
+    GenerateCastConstraint(I, blame);
   }
 }
 
-void ConstraintGenerator::GeneratePointerDerefConstraint(Pointer buf, const string &location) {
-  string blame("Pointer Dereference [" + location + "]");
+void ConstraintGenerator::GeneratePointerDerefConstraint(Pointer buf, Location location) {
+  static const BlameMessage blame("Pointer Dereference");
   Constraint cMax(blame, location), cMin(blame, location);
 
   cMax.addBig(buf.NameExpression(VarLiteral::MAX, VarLiteral::LEN_WRITE));
-  cp_.AddConstraint(cMax);
-  LOG << "Adding - " << buf.NameExpression(VarLiteral::MAX, VarLiteral::LEN_WRITE) << " >= 0 \n";
+  AddConstraint(cMax);
+  LOG_TRACE << "Adding - " << VarTable::Name(buf.NameExpression(VarLiteral::MAX, VarLiteral::LEN_WRITE))
+      << " >= 0 \n";
 
   cMin.addSmall(buf.NameExpression(VarLiteral::MIN, VarLiteral::LEN_WRITE));
-  cp_.AddConstraint(cMin);
-  LOG << "Adding - " << buf.NameExpression(VarLiteral::MIN, VarLiteral::LEN_WRITE) << " <= 0 \n";
+  AddConstraint(cMin);
+  LOG_TRACE << "Adding - " << VarTable::Name(buf.NameExpression(VarLiteral::MIN, VarLiteral::LEN_WRITE))
+      << " <= 0 \n";
 }
 
 void ConstraintGenerator::GenerateStoreConstraint(const StoreInst* I) {
-  string loc = GetInstructionFilename(I);
+  Location loc = GetInstructionLocation(I);
   if (const PointerType *pType = dyn_cast<const PointerType>(I->getPointerOperand()->getType())) {
     if (!(pType->getElementType()->isPointerTy())) {
       // store into a pointer - store int value
+      static const BlameMessage blame("store instruction");
       Integer intLiteral(I->getPointerOperand());
-      GenerateGenericConstraint(intLiteral, I->getValueOperand(), VarLiteral::USED,
-                                "store instruction", loc);
+      GenerateGenericConstraint(intLiteral, I->getValueOperand(), VarLiteral::USED, blame, loc);
       GeneratePointerDerefConstraint(makePointer(I->getPointerOperand()), loc);
     } else {
       Pointer pFrom(makePointer(I->getValueOperand())), pTo(makePointer(I->getPointerOperand()));
       GenerateBufferAliasConstraint(pFrom, pTo, loc);
+      AddPointsTo(STORE, pTo, pFrom);
 //      GeneratePointerDerefConstraint(I->getPointerOperand());
     }
   } else {
-    LOG << "Error - Trying to store into a non pointer type" << endl;
+    LOG_ERROR << "Error - Trying to store into a non pointer type" << endl;
   }
 }
 
 void ConstraintGenerator::AnalyzePointers() {
-  PointerAnalyzer analyzer;
-  analyzer.SetBuffers(buffers_);
+  pointerAnalyzer_.Solve();
+  Location location = LocationTable::FromText("(boa pointer analyzer)");
+  // The targets of all the pointers are found before any alias constraint is added.
+  vector<pair<Pointer, Buffer> > aliases;
+  vector<Buffer> buffers;
   for (set<Pointer>::iterator pi = unknownPointers_.begin(); pi != unknownPointers_.end(); ++pi) {
-    set<Buffer> buffers = analyzer.PointsTo(*pi);
-    for (set<Buffer>::iterator bi = buffers.begin(); bi != buffers.end(); ++bi) {
-      GenerateBufferAliasConstraint(*pi, *bi, "(boa pointer analyzer)");
-      LOG << "Pointer Analyzer" << endl;
+    pointerAnalyzer_.PointsTo(*pi, &buffers);
+    for (vector<Buffer>::iterator bi = buffers.begin(); bi != buffers.end(); ++bi) {
+      aliases.push_back(std::make_pair(*pi, *bi));
     }
   }
+  Profiler::Count("pointer analysis aliases", aliases.size());
+  for (size_t i = 0; i < aliases.size(); ++i) {
+    GenerateBufferAliasConstraint(aliases[i].first, aliases[i].second, location);
+    LOG_TRACE << "Pointer Analyzer" << endl;
+  }
 }
 
 void ConstraintGenerator::GenerateLoadConstraint(const LoadInst* I) {
-  string loc = GetInstructionFilename(I);
+  Location loc = GetInstructionLocation(I);
   if (const PointerType *pType = dyn_cast<const PointerType>(I->getPointerOperand()->getType())) {
     if (!(pType->getElementType()->isPointerTy())) {
       // load from a pointer - load int value
+      static const BlameMessage blame("load instruction");
       Integer intLiteral(I);
-      GenerateGenericConstraint(intLiteral, I->getPointerOperand(),VarLiteral::USED,
-                                "load instruction", loc);
+      GenerateGenericConstraint(intLiteral, I->getPointerOperand(), VarLiteral::USED, blame, loc);
       GeneratePointerDerefConstraint(I->getPointerOperand(), loc);
     } else {
       Pointer pFrom(I->getPointerOperand()), pTo(I);
       GenerateBufferAliasConstraint(pFrom, pTo, loc);
+      AddPointsTo(LOAD, pFrom, pTo);
 
       if (const PointerType *ppType = dyn_cast<const PointerType>(pType->getElementType())) {
         if (ppType->getElementType()->isPointerTy()) {
-          unknownPointers_.insert(pTo);
+          AddUnknownPointer(pTo);
         }
       }
     }
   } else {
-    LOG << "Error - Trying to load from a non pointer type" << endl;
+    LOG_ERROR << "Error - Trying to load from a non pointer type" << endl;
   }
 }
 
 void ConstraintGenerator::GenerateBufferAliasConstraint(VarLiteral from, VarLiteral to,
-                                                        const string& location,
+                                                        Location location,
                                                         const Value *offset,
                                                         const Constraint::Expression *offsetExp,
-                                                        const string& blame) {
+                                                        const BlameMessage* blame) {
   if ((offset != NULL) && (offsetExp != NULL)) {
     // only one type of offset allowed
-    LOG << "Error - GenerateBufferAliasConstraint got both offset and offsetExp" << endl;
+    LOG_ERROR << "Error - GenerateBufferAliasConstraint got both offset and offsetExp" << endl;
     return;
   }
 
+  static const BlameMessage alias("buffer alias"), aliasWithOffset("buffer alias with offset");
   Constraint::Type type = Constraint::ALIASING;
-  string aliasBlame = "buffer alias";
-  if (offset != NULL || offsetExp != NULL) {
-    aliasBlame += " with offset";
-  }
-  if (blame != "") {
-    aliasBlame += " - " + blame;
-  }
+  const BlameMessage& aliasBlame = (blame != NULL) ? *blame :
+      ((offset != NULL || offsetExp != NULL) ? aliasWithOffset : alias);
 
   Constraint::Expression ToReadMax = to.NameExpression(VarLiteral::MAX, VarLiteral::LEN_READ);
   Constraint::Expression ToReadMin = to.NameExpression(VarLiteral::MIN, VarLiteral::LEN_READ);
@@ -471,6 +1033,7 @@ void ConstraintGenerator::GenerateBufferAliasConstraint(VarLiteral from, VarLite
   GenerateConstraint(ToWriteMax, FromWriteMax, VarLiteral::MIN, aliasBlame, location, type);
   GenerateConstraint(ToReadMin,  FromReadMin,  VarLiteral::MIN, aliasBlame, location, type);
   GenerateConstraint(ToWriteMin, FromWriteMin, VarLiteral::MAX, aliasBlame, location, type);
+  AddPointsTo(COPY, from, to);
 }
 
 
@@ -478,7 +1041,8 @@ void ConstraintGenerator::GenerateShiftConstraint(const BinaryOperator* I) {
   Integer intLiteral(I);
   Expression operand1 = GenerateIntegerExpression(I->getOperand(1), VarLiteral::MAX);
   if (!operand1.IsConst()) {
-    GenerateUnboundConstraint(intLiteral, "Non-const shift factor.", GetInstructionFilename(I));
+    static const BlameMessage unbound("Non-const shift factor.");
+    GenerateUnboundConstraint(intLiteral, unbound, GetInstructionLocation(I));
     return;
   }
   double shiftFactor = 1 << (int)operand1.GetConst();
@@ -495,11 +1059,13 @@ void ConstraintGenerator::GenerateShiftConstraint(const BinaryOperator* I) {
       maxOperand.div(shiftFactor);
       break;
     default:
-      GenerateUnboundConstraint(intLiteral, "Logical Shr - unbound.", GetInstructionFilename(I));
+      static const BlameMessage unbound("Logical Shr - unbound.");
+      GenerateUnboundConstraint(intLiteral, unbound, GetInstructionLocation(I));
       return;
   }
 
-  string blame = "Shift operation", loc = GetInstructionFilename(I);
+  static const BlameMessage blame("Shift operation");
+  Location loc = GetInstructionLocation(I);
 
   GenerateConstraint(intLiteral, maxOperand, VarLiteral::USED, VarLiteral::MAX, blame, loc);
   GenerateConstraint(intLiteral, minOperand, VarLiteral::USED, VarLiteral::MAX, blame, loc);
@@ -509,7 +1075,8 @@ void ConstraintGenerator::GenerateShiftConstraint(const BinaryOperator* I) {
 
 void ConstraintGenerator::GenerateOrXorConstraint(const Instruction* I) {
     Integer intLiteral(I);
-    GenerateUnboundConstraint(intLiteral, "(X)OR operation", GetInstructionFilename(I));
+    static const BlameMessage unbound("(X)OR operation");
+    GenerateUnboundConstraint(intLiteral, unbound, GetInstructionLocation(I));
 }
 
 void ConstraintGenerator::SaveDbgDeclare(const DbgDeclareInst* D) {
@@ -519,6 +1086,8 @@ void ConstraintGenerator::SaveDbgDeclare(const DbgDeclareInst* D) {
   if (const PointerType *pType = dyn_cast<const PointerType>(D->getAddress()->getType())) {
     if (const StructType *sType = dyn_cast<const StructType>(pType->getElementType())) {
       if (const MDNode *node = dyn_cast<const MDNode>(D->getVariable()->getOperand(5))) {
+        // The buffers of a struct are added once, by the first function which declares it.
+        cacheable_ = false;
         AddContainedBuffers(sType, node);
         return;
       }
@@ -527,15 +1096,16 @@ void ConstraintGenerator::SaveDbgDeclare(const DbgDeclareInst* D) {
   if (const MDString *S = dyn_cast<const MDString>(D->getVariable()->getOperand(2))) {
     if (const MDNode *node = dyn_cast<const MDNode>(D->getVariable()->getOperand(3))) {
       if (const MDString *file = dyn_cast<const MDString>(node->getOperand(1))) {
-        LOG << (void*)D->getAddress() << " name = " << S->getString().str() << " Source location - "
-            << file->getString().str() << ":" << D->getDebugLoc().getLine() << endl;
+        Location location = LocationTable::FromFileLine(file->getString().str(),
+                                                        D->getDebugLoc().getLine());
+        string filename = LocationTable::ToString(location);
+        LOG_DEBUG << (void*)D->getAddress() << " name = " << S->getString().str() << " Source location - "
+            << filename << endl;
 
-        stringstream ss;
-        ss << file->getString().str() << ":" << D->getDebugLoc().getLine();
-        Buffer b(D->getAddress(), S->getString().str(), ss.str());
+        Buffer b(D->getAddress(), S->getString().str(), filename);
 
         if (allocedBuffers_[D->getAddress()]) {
-          AddBuffer(b, ss.str());
+          AddBuffer(b, location);
         }
 
         return;
@@ -543,17 +1113,17 @@ void ConstraintGenerator::SaveDbgDeclare(const DbgDeclareInst* D) {
     }
   }
   // else
-  LOG << "Can't extract debug info\n";
+  LOG_DEBUG << "Can't extract debug info\n";
 }
 
 void ConstraintGenerator::GenerateAllocConstraint(const Value *I, const ArrayType *aType,
-                                                  const string& location) {
+                                                  Location location) {
   Buffer buf(I);
   double allocSize = aType->getNumElements();
   Constraint allocMax, allocMin;
   allocedBuffers_[I] = true;
 
-  string blame = "Buffer allocation";
+  static const BlameMessage blame("Buffer allocation");
 
   GenerateConstraint(buf, allocSize, VarLiteral::ALLOC, VarLiteral::MAX, blame, location);
   GenerateConstraint(buf, allocSize, VarLiteral::ALLOC, VarLiteral::MIN, blame, location);
@@ -578,9 +1148,12 @@ void ConstraintGenerator::AddContainedBuffers(const StructType *structType, cons
               string memberName = structName + "." + memberNameNode->getString().str();
               Buffer buf(structType, memberName, "", false, typeIt);
               double allocSize = aType->getNumElements();
-              GenerateConstraint(buf, allocSize, VarLiteral::ALLOC, VarLiteral::MAX, "Struct alloc", "");
-              GenerateConstraint(buf, allocSize, VarLiteral::ALLOC, VarLiteral::MIN, "Struct alloc", "");
-              AddBuffer(buf, "");
+              static const BlameMessage blame("Struct alloc");
+              GenerateConstraint(buf, allocSize, VarLiteral::ALLOC, VarLiteral::MAX, blame,
+                                 Location());
+              GenerateConstraint(buf, allocSize, VarLiteral::ALLOC, VarLiteral::MIN, blame,
+                                 Location());
+              AddBuffer(buf, Location());
             }
           }
         }
@@ -595,10 +1168,12 @@ void ConstraintGenerator::AddContainedBuffers(const StructType *structType, cons
 void ConstraintGenerator::GenerateAllocaConstraint(const AllocaInst *I) {
   if (const PointerType *pType = dyn_cast<const PointerType>(I->getType())) {
     if (const ArrayType *aType = dyn_cast<const ArrayType>(pType->getElementType())) {
-      GenerateAllocConstraint(I, aType, GetInstructionFilename(I));
+      GenerateAllocConstraint(I, aType, GetInstructionLocation(I));
       return;
     }
   }
+  // Not a buffer, but may hold pointers.
+  AddPointsTo(OBJECT, Pointer(I));
 }
 
 void ConstraintGenerator::GenerateGetElementPtrConstraint(const GetElementPtrInst *I) {
@@ -613,13 +1188,13 @@ void ConstraintGenerator::GenerateGetElementPtrConstraint(const GetElementPtrIns
           int offset = (int)dyn_cast<ConstantInt>(accessIdx)->getSExtValue();
           Buffer b(sType, offset);
           Pointer ptr(I);
-          GenerateBufferAliasConstraint(b, ptr, GetInstructionFilename(I));
+          GenerateBufferAliasConstraint(b, ptr, GetInstructionLocation(I));
           return;
         }
       }
     }
     Pointer b(pointerOp), ptr(I);
-    GenerateBufferAliasConstraint(b, ptr, GetInstructionFilename(I), accessIdx);
+    GenerateBufferAliasConstraint(b, ptr, GetInstructionLocation(I), accessIdx);
     return;
   }
 }
@@ -627,149 +1202,52 @@ void ConstraintGenerator::GenerateGetElementPtrConstraint(const GetElementPtrIns
 void ConstraintGenerator::GenerateCallConstraint(const CallInst* I) {
   Function* f = I->getCalledFunction();
   if (f == NULL) {
-    return;
-  }
-
-  string functionName = f->getNameStr(), location = GetInstructionFilename(I);
-
-  if (functionName == "malloc") {
-    GenerateMallocConstraint(I, location);
-    return;
-  }
-
-  if (functionName == "strdup") {
-    GenerateStrdupConstraint(I, location);
-    return;
-  }
-
-  if (functionName == "strlen") {
-    GenerateStrlenConstraint(I, location);
-    return;
-  }
-
-  if (functionName == "strcpy") {
-    GenerateStringCopyConstraint(I);
-    return;
-  }
-
-  if (functionName == "strncpy") {
-    GenerateStrNCopyConstraint(I, "strncpy call", location);
-    return;
-  }
-
-  if (functionName == "strxfrm") {
-    GenerateStrNCopyConstraint(I, "strxfrm call", location);
-    return;
-  }
-
-  if (functionName == "memchr") {
-    GenerateMemchrConstraint(I);
-    return;
-  }
-
-  if (functionName == "memcmp") {
-    GenerateMemcmpConstraint(I);
-    return;
-  }
-
-  if (Helpers::IsPrefix("llvm.memmove", functionName)) {
-    GenerateMemmoveConstraint(I);
-    return;
-  }
-
-  if (Helpers::IsPrefix("llvm.memset", functionName)) {
-    GenerateMemsetConstraint(I);
-    return;
-  }
-
-  if (Helpers::IsPrefix("llvm.memcpy", functionName)) {
-    GenerateMemcpyConstraint(I);
-    return;
-  }
-
-  if (functionName == "pipe") {
-    Expression one(1.0);
-    Pointer arr(makePointer(I->getArgOperand(0)));
-    GenerateConstraint(arr, one, VarLiteral::LEN_WRITE, VarLiteral::MAX, "pipe call",
-                       GetInstructionFilename(I));
-    GenerateConstraint(arr, one, VarLiteral::LEN_WRITE, VarLiteral::MIN, "pipe call",
-                       GetInstructionFilename(I));
-    return;
-  }
-
-  if (functionName == "sprintf") {
-    if (I->getNumOperands() != 3) {
-      Pointer to(makePointer(I->getArgOperand(0)));
-      GenerateUnboundConstraint(to, "sprintf with unknown length format string",
-          GetInstructionFilename(I));
-    } else {
-      GenerateStringCopyConstraint(I);
+    // A call through a pointer, of one of the address taken functions (whose parameters point
+    // anywhere, see VisitFunction). It may store any pointer through its arguments.
+    for (unsigned i = 0; i < I->getNumArgOperands(); ++i) {
+      if (I->getArgOperand(i)->getType()->isPointerTy()) {
+        AddPointsTo(ESCAPE, makePointer(I->getArgOperand(i)));
+      }
+    }
+    if (I->getType()->isPointerTy()) {
+      AddPointsTo(UNKNOWN, Pointer(I));
     }
     return;
   }
-  
-  if ((functionName == "strchr") || (functionName == "strrchr") || (functionName == "strpbrk")) {
-    Pointer to = makePointer(I->getArgOperand(0)), retval = makePointer(I);
-    Constraint::Expression end(to.NameExpression(VarLiteral::MAX, VarLiteral::LEN_READ));
-    
-    // worst case - strchr/strrchr return a pointer to the end of the buffer
-    GenerateBufferAliasConstraint(to, retval, location, NULL, &end);
-    return;
-  }
-
-  if (functionName == "strerror") {
-    // strerror return a read only buffer. Since we can't create a buffer of size 0 (this kind 
-    // of buffer will always result in overrun) 
-    // We model it by a temporary buffer of length 1, and the returned buffer is aliased both to
-    // the 0th and 1st place of the buffer. This way any write access to the buffer will result
-    // in buffer overrun, but read access won't.
-    Buffer buf(I, "strerror", GetInstructionFilename(I), true);
-    AddBuffer(buf, location);
-
-    Expression one(1.0);
-    GenerateConstraint(buf, one, VarLiteral::ALLOC, VarLiteral::MAX, "strerror call", location);
-    GenerateConstraint(buf, one, VarLiteral::ALLOC, VarLiteral::MIN, "strerror call", location);
-    GenerateBufferAliasConstraint(buf, makePointer(I), location, NULL, &one);
-    GenerateBufferAliasConstraint(buf, makePointer(I), location, NULL);
-    return;
-  }
-
-  if (functionName == "write") {
-    Pointer to(makePointer(I->getArgOperand(0)));
-    Expression minExp = GenerateIntegerExpression(I->getArgOperand(1), VarLiteral::MIN);
-    minExp.add(-1.0);
-    Expression maxExp = GenerateIntegerExpression(I->getArgOperand(1), VarLiteral::MAX);
-    maxExp.add(-1.0);
 
-    GenerateConstraint(to, maxExp, VarLiteral::LEN_WRITE, VarLiteral::MAX, "write call", location);
-    GenerateConstraint(to, minExp, VarLiteral::LEN_WRITE, VarLiteral::MIN, "write call", location);
-    return;
+  Location location = GetInstructionLocation(I);
+  StringRef name = f->getName();
+  const ModelTable::Model* model = models_->Find(name.data(), name.size());
+  if (model != NULL && model->kind_ != ModelTable::SAFE && model->kind_ != ModelTable::UNSAFE) {
+    if (model->Fits(I->getNumArgOperands())) {
+      GenerateModelConstraint(I, *model, location);
+      return;
+    }
+    LOG_ERROR << "The model of " << name.str() << " doesn't fit a call with " <<
+        I->getNumArgOperands() << " arguments" << endl;
   }
 
   // General function call
   if (f->isDeclaration()) {
     // Has no body, assuming overrun in each buffer, and unbound return value.
     const unsigned params = I->getNumOperands() - 1; // The last operand is the called function.
-    string blame;
+    static const BlameMessage unsafeCall("unsafe function call"), safeCall("safe function call"),
+        unknownCall("unknown function call");
+    const string functionName = name.str();
+    const bool unsafe = IsUnsafeFunction(model, functionName);
+    const bool safe = IsSafeFunction(model, functionName);
 
-    Constraint::Type priority = Constraint::NORMAL;
-
-    // Set blame and priority according to the function's level of safety.
+    // Set blame according to the function's level of safety, the function is its argument.
     // A function can be either safe, not safe, or unsafe.
-    if (IsUnsafeFunction(functionName)) {
-      blame = "unsafe function call " + functionName;
-    } else if (IsSafeFunction(functionName)) {
-      blame = "safe function call " + functionName;
-    } else {
-      blame = "unknown function call " + functionName;
-    }
+    const BlameMessage blame(unsafe ? unsafeCall : (safe ? safeCall : unknownCall), functionName);
 
     // Not safe and unsafe functions.
-    if (!IsSafeFunction(functionName)) {
+    if (!safe) {
       for (unsigned i = 0; i< params; ++i) {
         if (I->getOperand(i)->getType()->isPointerTy()) {
           Pointer p(makePointer(I->getOperand(i)));
-          GenerateUnboundConstraint(p, blame, location, priority);
+          GenerateUnboundConstraint(p, blame, location);
+          AddPointsTo(ESCAPE, p);
         }
       }
     }
@@ -777,118 +1255,209 @@ void ConstraintGenerator::GenerateCallConstraint(const CallInst* I) {
     // Safe function, return by pointer.
     if (I->getType()->isPointerTy()) {
       GenerateUnboundConstraint(makePointer(I), blame, location);
+      AddPointsTo(UNKNOWN, makePointer(I));
     } else {
       // Return by value.
       Integer intLiteral(I);
       GenerateUnboundConstraint(intLiteral, blame, location);
     }
   } else {
-    //has body, pass arguments
+    // Has body, pass the arguments to the instances of the parameters at this call site (see
+    // ConstraintProblem::Summarize).
+    static const BlameMessage parameter("pass integer parameter to a function"),
+        userCall("user function call"), summary("summary of function");
+    map<const void*, const void*> instances;
     int i = 0;
     for (Function::const_arg_iterator it = f->arg_begin(); it != f->arg_end(); ++it, ++i) {
-      if (it->getType()->isPointerTy()) {
-        Pointer from(I->getOperand(i)), to(it);
-        GenerateBufferAliasConstraint(from, to, GetInstructionFilename(I));
+      const Argument* arg = it;
+      const Use* use = &I->getOperandUse(i);
+      instances[arg] = use;
+      if (arg->getType()->isPointerTy()) {
+        Pointer from(I->getOperand(i)), to(use);
+        GenerateBufferAliasConstraint(from, to, GetInstructionLocation(I));
+        AddPointsTo(COPY, to, Pointer(arg));
       } else {
-        Integer to(it);
-        GenerateGenericConstraint(to, I->getOperand(i), VarLiteral::LEN_WRITE,
-                                  "pass integer parameter to a function", location);
+        Integer to(use);
+        GenerateGenericConstraint(to, I->getOperand(i), VarLiteral::LEN_WRITE, parameter,
+                                  location);
       }
     }
-    // get return value
+    // get return value, the last operand is the called function.
+    const Use* result = &I->getOperandUse(I->getNumOperands() - 1);
+    instances[f] = result;
     if (I->getType()->isPointerTy()) {
-      GenerateBufferAliasConstraint(makePointer(f), makePointer(I), GetInstructionFilename(I));
+      Pointer retval(result);
+      GenerateBufferAliasConstraint(retval, makePointer(I), GetInstructionLocation(I));
+      AddPointsTo(COPY, Pointer(f), retval);
     } else {
-      Integer intLiteral(I);
-      GenerateGenericConstraint(intLiteral, f, VarLiteral::USED, "user function call", location);
+      Integer retval(result), intLiteral(I);
+      GenerateConstraint(intLiteral, retval.NameExpression(VarLiteral::MAX), VarLiteral::USED,
+                         VarLiteral::MAX, userCall, location);
+      GenerateConstraint(intLiteral, retval.NameExpression(VarLiteral::MIN), VarLiteral::USED,
+                         VarLiteral::MIN, userCall, location);
     }
+    AddCallSite(f, instances, BlameInfo(BlameMessage(summary, name.str()), location));
   }
 }
 
-void ConstraintGenerator::GenerateStrNCopyConstraint(const CallInst* I, const string &blame,
-                                                     const string &location) {
-  Pointer to(makePointer(I->getArgOperand(0)));
-  Expression minExp = GenerateIntegerExpression(I->getArgOperand(2), VarLiteral::MIN);
+void ConstraintGenerator::GenerateModelConstraint(const CallInst* I,
+                                                  const ModelTable::Model& model,
+                                                  Location location) {
+  LOG_TRACE << I << " " << model.blames_[0].ToString() << endl;
+  switch (model.kind_) {
+    case ModelTable::ALLOC:
+      GenerateMallocConstraint(I, model, location);
+      break;
+    case ModelTable::DUPLICATE:
+      GenerateStrdupConstraint(I, model, location);
+      break;
+    case ModelTable::LENGTH:
+      GenerateStrlenConstraint(I, model, location);
+      break;
+    case ModelTable::STRING_COPY:
+      GenerateStringCopyConstraint(I, model, location);
+      break;
+    case ModelTable::FORMAT:
+      GenerateFormatConstraint(I, model, location);
+      break;
+    case ModelTable::BOUNDED_WRITE:
+      GenerateBoundedWriteConstraint(I, model, location);
+      break;
+    case ModelTable::FIXED_WRITE:
+      GenerateFixedWriteConstraint(I, model, location);
+      break;
+    case ModelTable::FIND:
+      GenerateFindConstraint(I, model, location);
+      break;
+    case ModelTable::STATIC_STRING:
+      GenerateStaticStringConstraint(I, model, location);
+      break;
+    case ModelTable::SEARCH:
+      GenerateMemchrConstraint(I, model, location);
+      break;
+    case ModelTable::COMPARE:
+      GenerateMemcmpConstraint(I, model, location);
+      break;
+    case ModelTable::MOVE:
+      GenerateMemmoveConstraint(I, model, location);
+      break;
+    case ModelTable::FILL:
+      GenerateMemsetConstraint(I, model, location);
+      break;
+    case ModelTable::COPY:
+      GenerateMemcpyConstraint(I, model, location);
+      break;
+    case ModelTable::SAFE:
+    case ModelTable::UNSAFE:
+      // Calls of declarations, see GenerateCallConstraint.
+      break;
+  }
+}
+
+void ConstraintGenerator::GenerateBoundedWriteConstraint(const CallInst* I,
+                                                         const ModelTable::Model& model,
+                                                         Location location) {
+  const BlameMessage& blame = model.blames_[0];
+  Pointer to(makePointer(I->getArgOperand(model.args_[0])));
+  Expression minExp = GenerateIntegerExpression(I->getArgOperand(model.args_[1]), VarLiteral::MIN);
   minExp.add(-1.0);
-  Expression maxExp = GenerateIntegerExpression(I->getArgOperand(2), VarLiteral::MAX);
+  Expression maxExp = GenerateIntegerExpression(I->getArgOperand(model.args_[1]), VarLiteral::MAX);
   maxExp.add(-1.0);
 
   GenerateConstraint(to, maxExp, VarLiteral::LEN_WRITE, VarLiteral::MAX, blame, location);
   GenerateConstraint(to, minExp, VarLiteral::LEN_WRITE, VarLiteral::MIN, blame, location);
 }
 
-bool ConstraintGenerator::IsSafeFunction(const string& name) {
-  static string safeFunctions[] = { "execv",
-                                    "fdopen",
-                                    "fopen",
-                                    "fprintf",
-                                    "fputc",
-                                    "fputs",
-                                    "free",
-                                    "fwrite",
-                                    "getopt",
-                                    "openlog",
-                                    "putc",
-                                    "putchar",
-                                    "puts",
-                                    "printf",
-                                    "setenv",
-                                    "strcmp",
-                                    "strcoll",
-                                    "strcspn",
-                                    "strncmp",
-                                    "strspn",
-                                    "strstr",
-                                    "strtok",
-                                    "syslog",
-                                    "vfprintf",
-                                    "vprintf",
-                                    "vsyslog" };
-  for (size_t i = 0; i < (sizeof(safeFunctions) / sizeof(string)); ++i) {
-    if (name == safeFunctions[i]) {
-      return true;
-    }
-  }
-  if (safeFunctions_.count(name) == 1) {
-    return true;
+void ConstraintGenerator::GenerateFixedWriteConstraint(const CallInst* I,
+                                                       const ModelTable::Model& model,
+                                                       Location location) {
+  const BlameMessage& blame = model.blames_[0];
+  // The second argument of the model is the last index written, not an argument of the call.
+  Expression last(static_cast<double>(model.args_[1]));
+  Pointer arr(makePointer(I->getArgOperand(model.args_[0])));
+  GenerateConstraint(arr, last, VarLiteral::LEN_WRITE, VarLiteral::MAX, blame, location);
+  GenerateConstraint(arr, last, VarLiteral::LEN_WRITE, VarLiteral::MIN, blame, location);
+}
+
+void ConstraintGenerator::GenerateFormatConstraint(const CallInst* I,
+                                                   const ModelTable::Model& model,
+                                                   Location location) {
+  // Only a format string without any conversion can have no more arguments, the result is then
+  // a copy of the format string.
+  if (I->getNumArgOperands() > model.args_[1] + 1) {
+    Pointer to(makePointer(I->getArgOperand(model.args_[0])));
+    GenerateUnboundConstraint(to, model.blames_[1], location);
+  } else {
+    GenerateStringCopyConstraint(I, model, location);
   }
-  return false;
+}
+
+void ConstraintGenerator::GenerateFindConstraint(const CallInst* I,
+                                                 const ModelTable::Model& model,
+                                                 Location location) {
+  Pointer to = makePointer(I->getArgOperand(model.args_[0])), retval = makePointer(I);
+  Constraint::Expression end(to.NameExpression(VarLiteral::MAX, VarLiteral::LEN_READ));
+
+  // worst case - strchr/strrchr return a pointer to the end of the buffer
+  GenerateBufferAliasConstraint(to, retval, location, NULL, &end);
+}
+
+void ConstraintGenerator::GenerateStaticStringConstraint(const CallInst* I,
+                                                         const ModelTable::Model& model,
+                                                         Location location) {
+  // strerror return a read only buffer. Since we can't create a buffer of size 0 (this kind
+  // of buffer will always result in overrun)
+  // We model it by a temporary buffer of length 1, and the returned buffer is aliased both to
+  // the 0th and 1st place of the buffer. This way any write access to the buffer will result
+  // in buffer overrun, but read access won't.
+  const BlameMessage& blame = model.blames_[0];
+  Buffer buf(I, model.function_, LocationTable::ToString(location), true);
+  AddBuffer(buf, location);
+
+  Expression one(1.0);
+  GenerateConstraint(buf, one, VarLiteral::ALLOC, VarLiteral::MAX, blame, location);
+  GenerateConstraint(buf, one, VarLiteral::ALLOC, VarLiteral::MIN, blame, location);
+  GenerateBufferAliasConstraint(buf, makePointer(I), location, NULL, &one);
+  GenerateBufferAliasConstraint(buf, makePointer(I), location, NULL);
+}
+
+bool ConstraintGenerator::IsSafeFunction(const string& name) {
+  return IsSafeFunction(models_->Find(name), name);
 }
 
 bool ConstraintGenerator::IsUnsafeFunction(const string& name) {
-  static string unsafeFunctions[] = { "gets",
-                                      "scanf",
-                                      "strcat",
-                                      "strncat" };
-  for (size_t i = 0; i < (sizeof(unsafeFunctions) / sizeof(string)); ++i) {
-    if (name == unsafeFunctions[i]) {
-      return true;
-    }
-  }
-  if (unsafeFunctions_.count(name) == 1) {
-    return true;
-  }
-  return false;
+  return IsUnsafeFunction(models_->Find(name), name);
 }
 
-void ConstraintGenerator::GenerateStringCopyConstraint(const CallInst* I) {
-    Pointer from(makePointer(I->getArgOperand(1)));
-    Pointer to(makePointer(I->getArgOperand(0)));
-    string loc = GetInstructionFilename(I);
+bool ConstraintGenerator::IsSafeFunction(const ModelTable::Model* model, const string& name) {
+  return (model != NULL && model->kind_ == ModelTable::SAFE) || safeFunctions_.count(name) == 1;
+}
+
+bool ConstraintGenerator::IsUnsafeFunction(const ModelTable::Model* model, const string& name) {
+  return (model != NULL && model->kind_ == ModelTable::UNSAFE) ||
+         unsafeFunctions_.count(name) == 1;
+}
+
+void ConstraintGenerator::GenerateStringCopyConstraint(const CallInst* I,
+                                                       const ModelTable::Model& model,
+                                                       Location location) {
+    const BlameMessage& blame = model.blames_[0];
+    Pointer from(makePointer(I->getArgOperand(model.args_[1])));
+    Pointer to(makePointer(I->getArgOperand(model.args_[0])));
 
     GenerateConstraint(to.NameExpression(VarLiteral::MAX, VarLiteral::LEN_WRITE),
                        from.NameExpression(VarLiteral::MAX, VarLiteral::LEN_READ),
-                       VarLiteral::MAX, "strcpy call", loc);
+                       VarLiteral::MAX, blame, location);
     GenerateConstraint(to.NameExpression(VarLiteral::MIN, VarLiteral::LEN_WRITE),
                        from.NameExpression(VarLiteral::MIN, VarLiteral::LEN_READ),
-                       VarLiteral::MIN, "strcpy call", loc);
+                       VarLiteral::MIN, blame, location);
 }
 
 void ConstraintGenerator::GenerateGenericConstraint(const VarLiteral &var,
                                                     const Value *integerExpression,
                                                     VarLiteral::ExpressionType type,
-                                                    const string &blame,
-                                                    const string &location /* = "" */,
+                                                    const BlameMessage &blame,
+                                                    Location location /* = Location() */,
                                                     const Expression &offset /* = NULL */) {
   Expression maxExpr = GenerateIntegerExpression(integerExpression, VarLiteral::MAX);
   maxExpr.add(offset);
@@ -921,13 +1490,15 @@ Constraint::Expression ConstraintGenerator::GenerateIntegerExpression(const Valu
   return result;
 }
 
-void ConstraintGenerator::GenerateUnboundConstraint(const VarLiteral &var, const string &blame,
-                                                    const string& location /* = "" */,
-                                                    Constraint::Type prio /* = NORMAL */) {
-  GenerateConstraint(var, Expression::PosInfinity, VarLiteral::LEN_WRITE,
-                     VarLiteral::MAX, blame, location, prio);
-  GenerateConstraint(var, Expression::NegInfinity, VarLiteral::LEN_WRITE,
-                     VarLiteral::MIN, blame, location, prio);
+void ConstraintGenerator::GenerateUnboundConstraint(const VarLiteral &var,
+                                                    const BlameMessage &blame,
+                                                    Location location /* = Location() */) {
+  BlameInfo info(blame, location);
+  AddUnbounded(var.NameExpression(VarLiteral::MAX, VarLiteral::LEN_WRITE), info);
+  AddUnbounded(var.NameExpression(VarLiteral::MIN, VarLiteral::LEN_WRITE), info);
+  LOG_TRACE << "Adding - " << VarTable::Name(var.NameExpression(VarLiteral::MAX,
+                                                                VarLiteral::LEN_WRITE)) <<
+      " unbounded - " << blame.ToString() << endl;
 }
 
 
@@ -935,8 +1506,8 @@ void ConstraintGenerator::GenerateConstraint(const VarLiteral &var,
                                              const Expression &integerExpression,
                                              VarLiteral::ExpressionType type,
                                              VarLiteral::ExpressionDir direction,
-                                             const string &blame,
-                                             const string &location,
+                                             const BlameMessage &blame,
+                                             Location location,
                                              Constraint::Type prio) {
   GenerateConstraint(var.NameExpression(direction, type), integerExpression,
                      direction, blame, location, prio);
@@ -944,35 +1515,37 @@ void ConstraintGenerator::GenerateConstraint(const VarLiteral &var,
 
 void ConstraintGenerator::GenerateConstraint(const Expression &lhs, const Expression &rhs,
                                              VarLiteral::ExpressionDir direction,
-                                             const string &blame, const string &location,
+                                             const BlameMessage &blame, Location location,
                                              Constraint::Type prio) {
   Constraint constraint(lhs, rhs, direction);
   constraint.SetBlame(blame, location, prio);
-  cp_.AddConstraint(constraint);
-  LOG << "Adding - " << lhs.toString() << (direction == VarLiteral::MAX ? " >= " : " <= ") <<
-      rhs.toString() << " - " + blame << endl;
+  AddConstraint(constraint);
+  LOG_TRACE << "Adding - " << lhs.toString() << (direction == VarLiteral::MAX ? " >= " : " <= ") <<
+      rhs.toString() << " - " << blame.ToString() << endl;
 }
 
 void ConstraintGenerator::GenerateBooleanConstraint(const Instruction *I) {
+  static const BlameMessage blame("Boolean Operation");
   // Assuming result is of type i1, not [N x i1].
   Integer boolean(I);
-  string loc = GetInstructionFilename(I);
+  Location loc = GetInstructionLocation(I);
 
   GenerateConstraint(boolean, 1.0, VarLiteral::USED,
-                     VarLiteral::MAX, "Boolean Operation", loc);
+                     VarLiteral::MAX, blame, loc);
   GenerateConstraint(boolean, 0.0, VarLiteral::USED,
-                     VarLiteral::MIN, "Boolean Operation", loc);
+                     VarLiteral::MIN, blame, loc);
 }
 
 void ConstraintGenerator::GeneratePhiConstraint(const PHINode *I) {
-  string blame = "Phi Node", loc = GetInstructionFilename(I);
-  LOG << "Phi Node at " << I << " (" << blame << ")" << endl;
+  static const BlameMessage blame("Phi Node"), aliasBlame("buffer alias - Phi Node");
+  Location loc = GetInstructionLocation(I);
+  LOG_TRACE << "Phi Node at " << I << " (" << blame.ToString() << ")" << endl;
   const unsigned numVals = I->getNumIncomingValues();
   if (I->getType()->isPointerTy()) {
     Pointer phiNode(I);
     for (unsigned i = 0; i < numVals; i++) {
       Pointer from(I->getIncomingValue(i));
-      GenerateBufferAliasConstraint(from, phiNode, loc, NULL, NULL, blame);
+      GenerateBufferAliasConstraint(from, phiNode, loc, NULL, NULL, &aliasBlame);
     }
   } else {
     Integer phiNode(I);
@@ -984,13 +1557,16 @@ void ConstraintGenerator::GeneratePhiConstraint(const PHINode *I) {
 
 void ConstraintGenerator::GenerateSelectConstraint(const SelectInst *I) {
   Integer select(I);
-  string blame = "Ternary operator at ", loc = GetInstructionFilename(I);
-  LOG << "Select Node at " << I << " (" << blame << ")" << endl;
+  static const BlameMessage blame("Ternary operator at ");
+  Location loc = GetInstructionLocation(I);
+  LOG_TRACE << "Select Node at " << I << " (" << blame.ToString() << ")" << endl;
   GenerateGenericConstraint(select, I->getTrueValue(), VarLiteral::USED, blame, loc);
   GenerateGenericConstraint(select, I->getFalseValue(), VarLiteral::USED, blame, loc);
 }
 
-void ConstraintGenerator::GenerateMallocConstraint(const CallInst* I, const string& location) {
+void ConstraintGenerator::GenerateMallocConstraint(const CallInst* I,
+                                                   const ModelTable::Model& model,
+                                                   Location location) {
   // malloc calls are of the form:
   //   %2 = call i8* @malloc(i64 4)
   //   ...
@@ -998,17 +1574,19 @@ void ConstraintGenerator::GenerateMallocConstraint(const CallInst* I, const stri
   //
   // This method generates an Alloc expression for the malloc call, and the store instruction will
   // generate a BufferAlias.
-  LOG << I << " malloc call" << endl;
-  Buffer buf(I, "malloc", location);
-  GenerateGenericConstraint(buf, I->getArgOperand(0), VarLiteral::ALLOC, "malloc call", location);
+  Buffer buf(I, model.function_, LocationTable::ToString(location));
+  GenerateGenericConstraint(buf, I->getArgOperand(model.args_[0]), VarLiteral::ALLOC,
+                            model.blames_[0], location);
   AddBuffer(buf, location);
 }
 
-void ConstraintGenerator::GenerateStrdupConstraint(const CallInst* I, const string &location) {
-  static const string blame = "strdup call";
-  Buffer buf(I, "strdup", GetInstructionFilename(I));
+void ConstraintGenerator::GenerateStrdupConstraint(const CallInst* I,
+                                                   const ModelTable::Model& model,
+                                                   Location location) {
+  const BlameMessage& blame = model.blames_[0];
+  Buffer buf(I, model.function_, LocationTable::ToString(location));
   AddBuffer(buf, location);
-  Pointer from(I->getArgOperand(0));
+  Pointer from(I->getArgOperand(model.args_[0]));
 
   Expression maxExp(from.NameExpression(VarLiteral::MAX, VarLiteral::LEN_READ));
   Expression minExp(from.NameExpression(VarLiteral::MIN, VarLiteral::LEN_READ));
@@ -1023,9 +1601,11 @@ void ConstraintGenerator::GenerateStrdupConstraint(const CallInst* I, const stri
   GenerateConstraint(buf, minExp, VarLiteral::LEN_WRITE, VarLiteral::MIN, blame, location);
 }
 
-void ConstraintGenerator::GenerateStrlenConstraint(const CallInst* I, const string &location) {
-  static const string blame = "strlen call";
-  Pointer p(makePointer(I->getArgOperand(0)));
+void ConstraintGenerator::GenerateStrlenConstraint(const CallInst* I,
+                                                   const ModelTable::Model& model,
+                                                   Location location) {
+  const BlameMessage& blame = model.blames_[0];
+  Pointer p(makePointer(I->getArgOperand(model.args_[0])));
   Integer var(I);
 
   Expression pMax(p.NameExpression(VarLiteral::MAX, VarLiteral::LEN_READ));
@@ -1036,33 +1616,35 @@ void ConstraintGenerator::GenerateStrlenConstraint(const CallInst* I, const stri
   GenerateConstraint(var, pMin, VarLiteral::LEN_READ, VarLiteral::MIN, blame, location);
 }
 
-void ConstraintGenerator::GenerateMemchrConstraint(const CallInst* I) {
-  static const string readBlame("memchr call might read beyond the buffer");
-  static const string returnBlame("use of memchr return value");
-  string location(GetInstructionFilename(I));
+void ConstraintGenerator::GenerateMemchrConstraint(const CallInst* I,
+                                                   const ModelTable::Model& model,
+                                                   Location location) {
+  const BlameMessage& readBlame = model.blames_[0];
+  const BlameMessage& returnBlame = model.blames_[1];
 
-  Pointer s(makePointer(I->getOperand(0)));
+  Pointer s(makePointer(I->getArgOperand(model.args_[0])));
   Pointer retval(makePointer(I));
 
   // Generate constraints for the reading operation of memchr.
-  const Value* n = I->getOperand(2);
+  const Value* n = I->getArgOperand(model.args_[1]);
   GenerateGenericConstraint(s, n, VarLiteral::LEN_WRITE, readBlame, location, -1.0);
 
   // Mark the return value as an alias.
-  GenerateBufferAliasConstraint(s, retval, location, n, NULL, returnBlame);
+  GenerateBufferAliasConstraint(s, retval, location, n, NULL, &returnBlame);
 }
 
-void ConstraintGenerator::GenerateMemcmpConstraint(const CallInst* I) {
-  static const string blame("memcmp might read beyond array boundaries");
-  static const string returnBlame("use of memcmp return value");
-  string location(GetInstructionFilename(I));
+void ConstraintGenerator::GenerateMemcmpConstraint(const CallInst* I,
+                                                   const ModelTable::Model& model,
+                                                   Location location) {
+  const BlameMessage& blame = model.blames_[0];
+  const BlameMessage& returnBlame = model.blames_[1];
 
-  Pointer s1(makePointer(I->getOperand(0)));
-  Pointer s2(makePointer(I->getOperand(1)));
+  Pointer s1(makePointer(I->getArgOperand(model.args_[0])));
+  Pointer s2(makePointer(I->getArgOperand(model.args_[1])));
   Integer retval(I);
 
   // Generate constraints for the reading operation of memchr.
-  const Value* n = I->getOperand(2);
+  const Value* n = I->getArgOperand(model.args_[2]);
   GenerateGenericConstraint(s1, n, VarLiteral::LEN_WRITE, blame, location, -1.0);
   GenerateGenericConstraint(s2, n, VarLiteral::LEN_WRITE, blame, location, -1.0);
 
@@ -1070,15 +1652,16 @@ void ConstraintGenerator::GenerateMemcmpConstraint(const CallInst* I) {
   GenerateUnboundConstraint(retval, returnBlame, location);
 }
 
-void ConstraintGenerator::GenerateMemmoveConstraint(const CallInst* I) {
-  static const string sourceBlame("memmove source buffer");
-  static const string destBlame("memmove destination buffer");
-  static const string returnBlame("use of memmove return value");
-  string location(GetInstructionFilename(I));
+void ConstraintGenerator::GenerateMemmoveConstraint(const CallInst* I,
+                                                    const ModelTable::Model& model,
+                                                    Location location) {
+  const BlameMessage& sourceBlame = model.blames_[0];
+  const BlameMessage& destBlame = model.blames_[1];
+  const BlameMessage& returnBlame = model.blames_[2];
 
-  const Value* n = I->getOperand(2);
-  Pointer destination(makePointer(I->getOperand(0)));
-  Pointer source(makePointer(I->getOperand(1)));
+  const Value* n = I->getArgOperand(model.args_[2]);
+  Pointer destination(makePointer(I->getArgOperand(model.args_[0])));
+  Pointer source(makePointer(I->getArgOperand(model.args_[1])));
   Pointer retval(makePointer(I));
 
   // Model the read and write to source and destination.
@@ -1086,62 +1669,82 @@ void ConstraintGenerator::GenerateMemmoveConstraint(const CallInst* I) {
   GenerateGenericConstraint(destination, n, VarLiteral::LEN_WRITE, destBlame, location, -1.0);
 
   // Model the return value, which is destination.
-  GenerateBufferAliasConstraint(destination, retval, location, NULL, NULL, returnBlame);
+  GenerateBufferAliasConstraint(destination, retval, location, NULL, NULL, &returnBlame);
+  GenerateMemoryCopyPointsTo(destination, source, I);
 }
 
-void ConstraintGenerator::GenerateMemsetConstraint(const CallInst* I) {
-  static const string blame("memset might write beyond array boundaries");
-  string location(GetInstructionFilename(I));
+void ConstraintGenerator::GenerateMemsetConstraint(const CallInst* I,
+                                                   const ModelTable::Model& model,
+                                                   Location location) {
+  const BlameMessage& blame = model.blames_[0];
 
-  Pointer s(makePointer(I->getOperand(0)));
+  Pointer s(makePointer(I->getArgOperand(model.args_[0])));
 
   // Generate constraints for the reading operation of memchr.
-  const Value* n = I->getOperand(2);
+  const Value* n = I->getArgOperand(model.args_[1]);
   GenerateGenericConstraint(s, n, VarLiteral::LEN_WRITE, blame, location, -1.0);
 }
 
-void ConstraintGenerator::GenerateMemcpyConstraint(const CallInst* I) {
-  string location = GetInstructionFilename(I);
-  Pointer dest(makePointer(I->getArgOperand(0))), src(makePointer(I->getArgOperand(1)));
+void ConstraintGenerator::GenerateMemcpyConstraint(const CallInst* I,
+                                                   const ModelTable::Model& model,
+                                                   Location location) {
+  Pointer dest(makePointer(I->getArgOperand(model.args_[0])));
+  Pointer src(makePointer(I->getArgOperand(model.args_[1])));
   Pointer to(makePointer(I));
 
-  Expression minExp = GenerateIntegerExpression(I->getArgOperand(2), VarLiteral::MIN);
+  const Value* n = I->getArgOperand(model.args_[2]);
+  Expression minExp = GenerateIntegerExpression(n, VarLiteral::MIN);
   minExp.add(-1.0);
-  Expression maxExp = GenerateIntegerExpression(I->getArgOperand(2), VarLiteral::MAX);
+  Expression maxExp = GenerateIntegerExpression(n, VarLiteral::MAX);
   maxExp.add(-1.0);
 
-  static const string blameDest = "memcpy write to destination buffer",
-                      blameSrc  = "memcpy read from source buffer";
+  const BlameMessage& blameDest = model.blames_[0];
+  const BlameMessage& blameSrc = model.blames_[1];
 
   GenerateConstraint(dest, maxExp, VarLiteral::LEN_WRITE, VarLiteral::MAX, blameDest, location);
   GenerateConstraint(dest, minExp, VarLiteral::LEN_WRITE, VarLiteral::MIN, blameDest, location);
   GenerateConstraint(src, maxExp, VarLiteral::LEN_WRITE, VarLiteral::MAX, blameSrc, location);
   GenerateConstraint(src, minExp, VarLiteral::LEN_WRITE, VarLiteral::MIN, blameSrc, location);
   GenerateBufferAliasConstraint(dest, to, location);
+  GenerateMemoryCopyPointsTo(dest, src, I);
+}
+
+void ConstraintGenerator::GenerateMemoryCopyPointsTo(const Pointer& dest, const Pointer& src,
+                                                     const CallInst* I) {
+  // The pointers in the copied memory - copied = *src, *dest = copied, where copied is a temporary
+  // pointer of the call.
+  Pointer copied(I, true);
+  AddPointsTo(LOAD, src, copied);
+  AddPointsTo(STORE, dest, copied);
 }
 
 // Static.
-string ConstraintGenerator::GetInstructionFilename(const Instruction* I) {
+Location ConstraintGenerator::GetInstructionLocation(const Instruction* I) {
+  const MDNode* dbg = I->getMetadata(LLVMContext::MD_dbg);
+  if (!dbg) {
+    return Location();
+  }
+  Location location;
+  if (LocationTable::Lookup(dbg, &location)) {
+    return location;
+  }
   // Magic numbers that lead us through the various debug nodes to where the filename is.
-  if (I->getMetadata(LLVMContext::MD_dbg)) {
-    if (const MDNode* n1 =
-        dyn_cast<const MDNode>(I->getMetadata(LLVMContext::MD_dbg)->getOperand(2))) {
-      if (const MDNode* n2 = dyn_cast<const MDNode>(n1->getOperand(4))) {
-        if (const MDNode* filenamenode = dyn_cast<const MDNode>(n2->getOperand(3))) {
-          if (const MDString* filename =
-              dyn_cast<const MDString>(filenamenode->getOperand(3))) {
-            stringstream ss;
-            ss << filename->getString().str() << ":" << I->getDebugLoc().getLine();
-            return ss.str();
-          }
+  if (const MDNode* n1 = dyn_cast<const MDNode>(dbg->getOperand(2))) {
+    if (const MDNode* n2 = dyn_cast<const MDNode>(n1->getOperand(4))) {
+      if (const MDNode* filenamenode = dyn_cast<const MDNode>(n2->getOperand(3))) {
+        if (const MDString* filename =
+            dyn_cast<const MDString>(filenamenode->getOperand(3))) {
+          location = LocationTable::FromFileLine(filename->getString().str(),
+                                                 I->getDebugLoc().getLine());
         }
       }
     }
   }
-  return "";
+  LocationTable::Cache(dbg, location);
+  return location;
 }
 
-Pointer ConstraintGenerator::makePointer(const Value *I, const string& location /* = "" */) {
+Pointer ConstraintGenerator::makePointer(const Value *I, Location location /* = Location() */) {
   if (const ConstantExpr* G = dyn_cast<const ConstantExpr>(I)) { 
     Pointer b(G->getOperand(0)), ptr(I);
     Expression offsetExp = GenerateIntegerExpression(G->getOperand(G->getNumOperands()-2), 
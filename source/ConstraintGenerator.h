@@ -16,8 +16,12 @@ using std::map;
 
 #include "ConstraintProblem.h"
 #include "Buffer.h"
+#include "ConstraintCache.h"
 #include "Integer.h"
+#include "LocationTable.h"
+#include "ModelTable.h"
 #include "Pointer.h"
+#include "PointerAnalyzer.h"
 #include "log.h"
 
 #include "gtest_prod.h"
@@ -27,6 +31,8 @@ typedef boa::Constraint::Expression Expression;
 
 namespace boa {
 
+class FunctionNodes;
+
 class ConstraintGenerator {
   ConstraintProblem &cp_;
   /**
@@ -37,48 +43,103 @@ class ConstraintGenerator {
   set<const StructType*> structsVisited_;
   const set<string> safeFunctions_;
   const set<string> unsafeFunctions_;
+  // Models of library functions, see ModelTable.
+  const ModelTable* models_;
   set<Buffer> buffers_;
+  // Loaded pointers to pointers, whose buffers are found by the pointer analysis.
   set<Pointer> unknownPointers_;
+  PointerAnalyzer pointerAnalyzer_;
   bool IgnoreLiterals_;
+  // Cache of the constraints of functions, NULL if there is none.
+  const ConstraintCache* cache_;
+  /**
+    While a function is generated for the cache - the nodes it may refer to, and the record of
+    everything generated for it. NULL otherwise. cacheable_ is cleared once something which can't be
+    replayed is generated.
+  */
+  const FunctionNodes* nodes_;
+  ConstraintCache::Writer* record_;
+  bool cacheable_;
+
+  // Statements of the points-to analysis, see PointerAnalyzer.
+  enum PointsTo {OBJECT, UNKNOWN, ESCAPE, COPY, LOAD, STORE};
+
+  /**
+    Everything the generator produces goes through these methods, so a function's output can be
+    recorded for the cache (see VisitFunction) and replayed.
+  */
+  void AddConstraint(const Constraint& constraint);
+  void AddUnbounded(VarId var, const BlameInfo& blame);
+  void RegisterBuffer(const Buffer& buf);
+  void AddPointsTo(PointsTo statement, const VarLiteral& first, const VarLiteral& second);
+  void AddPointsTo(PointsTo statement, const VarLiteral& pointer) {
+    AddPointsTo(statement, pointer, pointer);
+  }
+  void AddUnknownPointer(const Pointer& pointer);
+  void AddCallSite(const Function* callee, const map<const void*, const void*>& instances,
+                   const BlameInfo& blame);
+
+  void RecordNode(const void* node);
+  void RecordVar(VarId var);
+  void RecordBlame(const BlameInfo& blame);
+
+  /**
+    Add the output recorded for a function, whose nodes are "nodes". If apply is false the record
+    is only validated. Return false if the record is malformed.
+  */
+  bool Replay(const FunctionNodes& nodes, const string& record, bool apply);
 
   /**
-    Set the bounds of an integer variable to be [-infinity , infinity]
+    The cache key of a function - a hash of its IR, of the debug information it uses and of the
+    generator options.
   */
-  void GenerateUnboundConstraint(const VarLiteral &var, const string &blame,
-                                 const string &location,
-                                 Constraint::Type prio = Constraint::NORMAL);
+  uint64_t CacheKey(const Function* F);
+
+  /**
+    Set the bounds of an integer variable to be [-infinity , infinity]. No row is added, the
+    variable is recorded as unbounded (see ConstraintProblem::AddUnbounded).
+  */
+  void GenerateUnboundConstraint(const VarLiteral &var, const BlameMessage &blame,
+                                 Location location);
 
   /**
     Generate a constraint on "var" according to the the integer value of "integerExpression"
   */
   void GenerateGenericConstraint(const VarLiteral &var, const Value *integerExpression,
-                                 VarLiteral::ExpressionType type, const string &blame,
-                                 const string &location, const Expression &offset = 0.0);
+                                 VarLiteral::ExpressionType type, const BlameMessage &blame,
+                                 Location location, const Expression &offset = 0.0);
 
   void GenerateConstraint(const VarLiteral &var, const Expression &integerExpression,
                           VarLiteral::ExpressionType type, VarLiteral::ExpressionDir direction,
-                          const string &blame, const string &location, 
+                          const BlameMessage &blame, Location location, 
                           Constraint::Type prio = Constraint::NORMAL);
 
   void GenerateConstraint(const Expression &lhs, const Expression &rhs,
                           VarLiteral::ExpressionDir direction,
-                          const string &blame, const string &location, 
+                          const BlameMessage &blame, Location location, 
                           Constraint::Type prio = Constraint::NORMAL);
 
   /**
-    Generate buffer aliasing constraint - "to" is aliased to "from" + "offset"
+    Generate buffer aliasing constraint - "to" is aliased to "from" + "offset". blame is the
+    complete blame of the alias rows, "buffer alias" (with offset) if it is NULL.
   */
-  void GenerateBufferAliasConstraint(VarLiteral from, VarLiteral to, const string& location,
+  void GenerateBufferAliasConstraint(VarLiteral from, VarLiteral to, Location location,
                                      const Value *offset = NULL,
                                      const Constraint::Expression *offsetExp = NULL,
-                                     const string& blame = "");
+                                     const BlameMessage* blame = NULL);
 
   /**
     Make a boa::Pointer instance out of an instruction parameter. This function should be used in
     order to deal with getElementPtr that might appear as a constantExpr (and not a reference to
     another instruction) in an instruction parameter.
   */
-  Pointer makePointer(const Value *I, const string& location = "");
+  Pointer makePointer(const Value *I, Location location = Location());
+
+  /**
+    Add the pointers of the initializer C of global GV (or of an element of it) to the points-to
+    analysis, as stored in GV.
+  */
+  void GenerateInitializerPointsTo(const GlobalVariable* GV, const Constant* C);
 
   /**
     Extract variable declration data from debug information
@@ -86,15 +147,16 @@ class ConstraintGenerator {
   void SaveDbgDeclare(const DbgDeclareInst* D);
 
   /**
-    Extract instruction filename from debug information
+    Extract instruction source location from debug information. The debug information of each
+    distinct debug location is walked only once, see LocationTable.
   */
-  static string GetInstructionFilename(const Instruction* I);
+  static Location GetInstructionLocation(const Instruction* I);
 
   /**
     Add a buffer to the constraint problem, together with the nessesary constraints. This method
     should be used instead of adding buffer directly to the constraintProblem.
   */
-  void AddBuffer(const Buffer& buf, const string& location, bool literal = false);
+  void AddBuffer(const Buffer& buf, Location location, bool literal = false);
 
   /**
     Generate the Constraint::Expression reflected by "expr". The result will be a number in a case
@@ -111,12 +173,12 @@ class ConstraintGenerator {
     Generate the constraints reflecting defreference of a pointer (usually accesing a buffer through
     alias)
   */
-  void GeneratePointerDerefConstraint(Pointer buf, const string &location);
+  void GeneratePointerDerefConstraint(Pointer buf, Location location);
 
   /**
     Generate buffer allocation constraints and register the buffer as allocated
   */
-  void GenerateAllocConstraint(const Value *I, const ArrayType *aType, const string& location);
+  void GenerateAllocConstraint(const Value *I, const ArrayType *aType, Location location);
 
   /**
    * Generate buffer allocation constraints and register buffers as allocated
@@ -139,16 +201,47 @@ class ConstraintGenerator {
   void GenerateCallConstraint(const CallInst* I);
   void GenerateReturnConstraint(const ReturnInst* I, const Function *F);
 
-  void GenerateStringCopyConstraint(const CallInst* I);
-  void GenerateStrNCopyConstraint(const CallInst* I, const string &blame, const string &location);
-  void GenerateMallocConstraint(const CallInst* I, const string &location);
-  void GenerateStrdupConstraint(const CallInst* I, const string &location);
-  void GenerateStrlenConstraint(const CallInst* I, const string &location);
-  void GenerateMemchrConstraint(const CallInst* I);
-  void GenerateMemmoveConstraint(const CallInst* I);
-  void GenerateMemcmpConstraint(const CallInst* I);
-  void GenerateMemsetConstraint(const CallInst* I);
-  void GenerateMemcpyConstraint(const CallInst* I);
+  /**
+    Generate the constraints of a call of a function with a model (see ModelTable). Each kind of
+    model has its own method, the model gives the arguments of the call to use.
+  */
+  void GenerateModelConstraint(const CallInst* I, const ModelTable::Model& model,
+                               Location location);
+
+  void GenerateStringCopyConstraint(const CallInst* I, const ModelTable::Model& model,
+                                    Location location);
+  void GenerateFormatConstraint(const CallInst* I, const ModelTable::Model& model,
+                                Location location);
+  void GenerateBoundedWriteConstraint(const CallInst* I, const ModelTable::Model& model,
+                                      Location location);
+  void GenerateFixedWriteConstraint(const CallInst* I, const ModelTable::Model& model,
+                                    Location location);
+  void GenerateFindConstraint(const CallInst* I, const ModelTable::Model& model,
+                              Location location);
+  void GenerateStaticStringConstraint(const CallInst* I, const ModelTable::Model& model,
+                                      Location location);
+  void GenerateMallocConstraint(const CallInst* I, const ModelTable::Model& model,
+                                Location location);
+  void GenerateStrdupConstraint(const CallInst* I, const ModelTable::Model& model,
+                                Location location);
+  void GenerateStrlenConstraint(const CallInst* I, const ModelTable::Model& model,
+                                Location location);
+  void GenerateMemchrConstraint(const CallInst* I, const ModelTable::Model& model,
+                                Location location);
+  void GenerateMemmoveConstraint(const CallInst* I, const ModelTable::Model& model,
+                                 Location location);
+  void GenerateMemcmpConstraint(const CallInst* I, const ModelTable::Model& model,
+                                Location location);
+  void GenerateMemsetConstraint(const CallInst* I, const ModelTable::Model& model,
+                                Location location);
+  void GenerateMemcpyConstraint(const CallInst* I, const ModelTable::Model& model,
+                                Location location);
+
+  /**
+    The points-to statements of call I copying the memory pointed by src to the memory pointed by
+    dest - the pointers stored in src's memory may be stored in dest's.
+  */
+  void GenerateMemoryCopyPointsTo(const Pointer& dest, const Pointer& src, const CallInst* I);
 
   /*
     Generate the constraints reflecting llvm arithmetic access instructions
@@ -158,7 +251,7 @@ class ConstraintGenerator {
   void GenerateMulConstraint(const BinaryOperator* I);
   void GenerateDivConstraint(const BinaryOperator* I);
 
-  void GenerateCastConstraint(const CastInst* I, const string& blame);
+  void GenerateCastConstraint(const CastInst* I, const BlameMessage& blame);
   void GenerateBitCastConstraint(const CastInst* I);
 
   void GenerateAndConstraint(const BinaryOperator* I);
@@ -171,13 +264,54 @@ class ConstraintGenerator {
   bool IsSafeFunction(const string& name);
   bool IsUnsafeFunction(const string& name);
 
+  /**
+    The same, for a function whose model was already looked up (NULL if it has none).
+  */
+  bool IsSafeFunction(const ModelTable::Model* model, const string& name);
+  bool IsUnsafeFunction(const ModelTable::Model* model, const string& name);
+
  public:
   ConstraintGenerator(ConstraintProblem &CP, bool ignoreLiterals, const set<string> &safeFunctions,
-                      const set<string> &unsafeFunctions) : cp_(CP), safeFunctions_(safeFunctions),
-                      unsafeFunctions_(unsafeFunctions), IgnoreLiterals_(ignoreLiterals) {}
+                      const set<string> &unsafeFunctions) :
+                      cp_(CP), safeFunctions_(safeFunctions), unsafeFunctions_(unsafeFunctions),
+                      models_(&ModelTable::Libc()), IgnoreLiterals_(ignoreLiterals),
+                      cache_(NULL), nodes_(NULL), record_(NULL), cacheable_(false) {}
 
+  /**
+    Reuse the constraints of functions which were generated by a previous run, and store the
+    constraints of new functions in cache.
+  */
+  void SetCache(const ConstraintCache* cache) {
+    cache_ = cache;
+  }
+
+  /**
+    Generate calls of library functions by models, instead of the built in libc models. models
+    must outlive the generator.
+  */
+  void SetModels(const ModelTable* models) {
+    models_ = models;
+  }
+
+  /**
+    Run the points-to analysis over the statements collected so far, and alias each of the
+    unknownPointers_ to the buffers it may point to.
+  */
   void AnalyzePointers();
 
+  /**
+    Generate constraints out of all the instructions of a function, and mark them as its body (see
+    ConstraintProblem::BeginFunction). With a cache, the constraints of a function whose IR is
+    unchanged are replayed from the cache instead.
+  */
+  void VisitFunction(const Function *F);
+
+  /**
+    False if the constraints of F can't matter to any buffer - F has no pointers, no result and
+    calls nothing but intrinsics - so it need not be visited at all.
+  */
+  static bool MayTouchBuffers(const Function *F);
+
   /**
     Generate constraints out of a specific instruction
   */
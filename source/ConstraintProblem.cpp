@@ -2,121 +2,773 @@
 
 #include "LinearProblem.h"
 
+#include <math.h>
+
+#include <algorithm>
 #include <iostream>
+#include <map>
+#include <utility>
 #include <glpk.h>
 #include "log.h"
+#include "DifferenceSolver.h"
+#include "Profiler.h"
+#include "Projection.h"
+#include "UnionFind.h"
 
 using std::endl;
+using std::lower_bound;
+using std::map;
+using std::sort;
+using std::unique;
 
 namespace boa {
-
+// Owners of variables which are in no row, and of variables in the rows of more than one function.
+static const int NO_OWNER = -1;
+static const int SHARED = -2;
 
 /**
- * A printing function for GLPK.
- *
- * @see { glpk.pdf / glp_term_hook }
- */
-static int printToLog(void *info, const char *s) {
-  log::os() << s;
-  return 1;  // Non zero.
+  The variable of var's bound for the node nodes maps var's node to, var if its node is not mapped.
+*/
+static VarId RenameVar(VarId var, const map<const void*, const void*>& nodes) {
+  map<const void*, const void*>::const_iterator it = nodes.find(VarTable::Node(var));
+  return (it == nodes.end()) ? var : VarTable::Rename(var, it->second);
+}
+
+static void AddInstance(const vector<Projection::Row>& summary,
+                        const map<const void*, const void*>& instances,
+                        vector<Projection::Row>* rows /* out */) {
+  for (size_t i = 0; i < summary.size(); ++i) {
+    Projection::Row row;
+    for (map<VarId, double>::const_iterator it = summary[i].coefs_.begin();
+         it != summary[i].coefs_.end(); ++it) {
+      row.coefs_[RenameVar(it->first, instances)] += it->second;
+    }
+    row.left_ = summary[i].left_;
+    row.type_ = summary[i].type_;
+    rows->push_back(row);
+  }
+}
+
+void ConstraintProblem::BeginFunction(const void* function, const vector<const void*>& interface) {
+  functionIndex_[function] = functions_.size();
+  Function f;
+  f.firstRow_ = f.endRow_ = constraints_.Size();
+  f.interface_ = interface;
+  functions_.push_back(f);
+}
+
+void ConstraintProblem::EndFunction() {
+  functions_.back().endRow_ = constraints_.Size();
+}
+
+void ConstraintProblem::AddCallSite(const void* callee,
+                                    const map<const void*, const void*>& instances,
+                                    const BlameInfo& blame) {
+  CallSite site;
+  site.caller_ = int(functions_.size()) - 1;
+  site.callee_ = callee;
+  site.instances_ = instances;
+  site.blame_ = blame;
+  callSites_.push_back(site);
+}
+
+bool ConstraintProblem::SummarizeFunction(size_t function, const vector<size_t>& sites,
+                                          const vector<int>& owner,
+                                          const vector<vector<Projection::Row> >& summaries,
+                                          const map<const void*, const void*>& bound,
+                                          vector<Projection::Row>* summary) const {
+  const Function& f = functions_[function];
+  vector<Projection::Row> rows;
+  for (size_t r = f.firstRow_; r < f.endRow_; ++r) {
+    Projection::Row row;
+    for (uint32_t e = constraints_.RowBegin(r); e < constraints_.RowEnd(r); ++e) {
+      row.coefs_[RenameVar(constraints_.Var(e), bound)] += constraints_.Coef(e);
+    }
+    row.left_ = constraints_.Left(r);
+    row.type_ = constraints_.GetType(r);
+    rows.push_back(row);
+  }
+  // The instances of summarized callees are local to the body.
+  set<const void*> instances;
+  for (size_t i = 0; i < sites.size(); ++i) {
+    const CallSite& site = callSites_[sites[i]];
+    AddInstance(summaries[functionIndex_.find(site.callee_)->second], site.instances_, &rows);
+    for (map<const void*, const void*>::const_iterator it = site.instances_.begin();
+         it != site.instances_.end(); ++it) {
+      instances.insert(it->second);
+    }
+  }
+
+  set<const void*> interface(f.interface_.begin(), f.interface_.end());
+  vector<bool> keep(VarTable::Size(), true);
+  for (size_t i = 0; i < rows.size(); ++i) {
+    for (map<VarId, double>::const_iterator it = rows[i].coefs_.begin();
+         it != rows[i].coefs_.end(); ++it) {
+      uint32_t var = it->first.Index();
+      int varOwner = (var < owner.size()) ? owner[var] : NO_OWNER;
+      if (interface.count(VarTable::Node(it->first)) != 0) {
+        if (varOwner != int(function) && varOwner != NO_OWNER) {
+          // Renaming the interface at call sites would disconnect its other rows.
+          return false;
+        }
+      } else if (instances.count(VarTable::Node(it->first)) != 0 || varOwner == int(function)) {
+        keep[var] = false;
+      }
+    }
+  }
+
+  Projection projection(rows.size());
+  for (size_t i = 0; i < rows.size(); ++i) {
+    projection.AddRow(rows[i]);
+  }
+  if (!projection.Project(keep)) {
+    return false;
+  }
+  summary->clear();
+  for (size_t i = 0; i < projection.Size(); ++i) {
+    summary->push_back(projection.GetRow(i));
+  }
+  return true;
 }
 
-set<string> ConstraintProblem::CollectVars() const {
-  set<string> vars;
+void ConstraintProblem::Summarize() {
+  ProfileScope scope("Summarize");
+  const size_t n = functions_.size();
+  vector<int> calleeOf(callSites_.size(), -1);
+  vector<vector<size_t> > sitesIn(n), sitesOf(n);
+  for (size_t s = 0; s < callSites_.size(); ++s) {
+    map<const void*, size_t>::const_iterator callee = functionIndex_.find(callSites_[s].callee_);
+    if (callee != functionIndex_.end()) {
+      calleeOf[s] = callee->second;
+      sitesOf[callee->second].push_back(s);
+    }
+    if (callSites_[s].caller_ >= 0) {
+      sitesIn[callSites_[s].caller_].push_back(s);
+    }
+  }
+
+  vector<bool> summarized(n, false);
+  vector<vector<Projection::Row> > summaries(n);
+  // Instance -> interface node, for the call sites bound to the callee's interface.
+  map<const void*, const void*> bound;
+
+  if (summaries_) {
+    vector<int> rowOwner(constraints_.Size(), SHARED);
+    for (size_t f = 0; f < n; ++f) {
+      for (size_t row = functions_[f].firstRow_; row < functions_[f].endRow_; ++row) {
+        rowOwner[row] = f;
+      }
+    }
+    vector<int> owner(VarTable::Size(), NO_OWNER);
+    for (size_t row = 0; row < constraints_.Size(); ++row) {
+      for (uint32_t e = constraints_.RowBegin(row); e < constraints_.RowEnd(row); ++e) {
+        int& o = owner[constraints_.Var(e).Index()];
+        o = (o == NO_OWNER || o == rowOwner[row]) ? rowOwner[row] : SHARED;
+      }
+    }
+    VarLiteral::ExpressionType types[] = { VarLiteral::USED, VarLiteral::ALLOC,
+                                           VarLiteral::LEN_READ, VarLiteral::LEN_WRITE };
+    for (set<Buffer>::const_iterator b = buffers_.begin(); b != buffers_.end(); ++b) {
+      for (size_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t) {
+        VarId max = b->NameExpression(VarLiteral::MAX, types[t]);
+        VarId min = b->NameExpression(VarLiteral::MIN, types[t]);
+        owner.resize(VarTable::Size(), NO_OWNER);
+        owner[max.Index()] = owner[min.Index()] = SHARED;
+      }
+    }
+    for (size_t i = 0; i < constraints_.UnboundedSize(); ++i) {
+      owner[constraints_.UnboundedVar(i).Index()] = SHARED;
+    }
+
+    // Callees are summarized before their callers, functions on a call cycle are never ready.
+    vector<size_t> pending(n, 0), ready;
+    for (size_t s = 0; s < callSites_.size(); ++s) {
+      if (calleeOf[s] != -1 && callSites_[s].caller_ >= 0) {
+        ++pending[callSites_[s].caller_];
+      }
+    }
+    for (size_t f = 0; f < n; ++f) {
+      if (pending[f] == 0) {
+        ready.push_back(f);
+      }
+    }
+    while (!ready.empty()) {
+      size_t f = ready.back();
+      ready.pop_back();
+      vector<size_t> sites;
+      for (size_t i = 0; i < sitesIn[f].size(); ++i) {
+        const CallSite& site = callSites_[sitesIn[f][i]];
+        if (calleeOf[sitesIn[f][i]] != -1 && summarized[calleeOf[sitesIn[f][i]]]) {
+          sites.push_back(sitesIn[f][i]);
+          continue;
+        }
+        for (map<const void*, const void*>::const_iterator it = site.instances_.begin();
+             it != site.instances_.end(); ++it) {
+          bound[it->second] = it->first;
+        }
+      }
+      if (!sitesOf[f].empty()) {
+        summarized[f] = SummarizeFunction(f, sites, owner, summaries, bound, &summaries[f]);
+      }
+      for (size_t i = 0; i < sitesOf[f].size(); ++i) {
+        int caller = callSites_[sitesOf[f][i]].caller_;
+        if (caller >= 0 && --pending[caller] == 0) {
+          ready.push_back(caller);
+        }
+      }
+    }
+  }
+
+  for (size_t s = 0; s < callSites_.size(); ++s) {
+    if (calleeOf[s] == -1 || !summarized[calleeOf[s]]) {
+      for (map<const void*, const void*>::const_iterator it = callSites_[s].instances_.begin();
+           it != callSites_[s].instances_.end(); ++it) {
+        bound[it->second] = it->first;
+      }
+    }
+  }
+
+  // Rebuild the store without the summarized bodies.
+  vector<bool> removed(constraints_.Size(), false);
+  size_t functionCount = 0, summaryRows = 0;
+  for (size_t f = 0; f < n; ++f) {
+    if (summarized[f]) {
+      ++functionCount;
+      for (size_t row = functions_[f].firstRow_; row < functions_[f].endRow_; ++row) {
+        removed[row] = true;
+      }
+    }
+  }
+  ConstraintStore store;
+  for (size_t row = 0; row < constraints_.Size(); ++row) {
+    if (removed[row]) {
+      continue;
+    }
+    map<VarId, double> coefs;
+    for (uint32_t e = constraints_.RowBegin(row); e < constraints_.RowEnd(row); ++e) {
+      coefs[RenameVar(constraints_.Var(e), bound)] += constraints_.Coef(e);
+    }
+    store.Add(coefs, constraints_.Left(row), constraints_.GetType(row), constraints_.Blame(row));
+  }
+  for (size_t s = 0; s < callSites_.size(); ++s) {
+    int caller = callSites_[s].caller_;
+    if (calleeOf[s] == -1 || !summarized[calleeOf[s]] || (caller >= 0 && summarized[caller])) {
+      continue;
+    }
+    vector<Projection::Row> rows;
+    AddInstance(summaries[calleeOf[s]], callSites_[s].instances_, &rows);
+    for (size_t i = 0; i < rows.size(); ++i) {
+      store.Add(rows[i].coefs_, rows[i].left_, rows[i].type_, callSites_[s].blame_);
+    }
+    summaryRows += rows.size();
+  }
+  for (size_t i = 0; i < constraints_.UnboundedSize(); ++i) {
+    store.AddUnbounded(RenameVar(constraints_.UnboundedVar(i), bound),
+                       constraints_.UnboundedBlame(i));
+  }
+
+  Profiler::Count("summarized functions", functionCount);
+  Profiler::Count("summary rows", summaryRows);
+  LOG_INFO << "Summarized " << functionCount << " of " << n << " functions, " <<
+      constraints_.Size() << " rows replaced by " << store.Size() << endl;
+  constraints_ = store;
+  functions_.clear();
+  functionIndex_.clear();
+  callSites_.clear();
+}
+
+
+vector<ConstraintProblem::Component> ConstraintProblem::Decompose() const {
+  ProfileScope scope("Decompose");
+  UnionFind sets(VarTable::Size());
+  for (size_t row = 0; row < constraints_.Size(); ++row) {
+    for (uint32_t e = constraints_.RowBegin(row) + 1; e < constraints_.RowEnd(row); ++e) {
+      sets.Union(constraints_.Var(constraints_.RowBegin(row)).Index(),
+                 constraints_.Var(e).Index());
+    }
+  }
   for (set<Buffer>::const_iterator buffer = buffers_.begin(); buffer != buffers_.end(); ++buffer) {
-    vars.insert(buffer->NameExpression(VarLiteral::MIN, VarLiteral::USED));
-    vars.insert(buffer->NameExpression(VarLiteral::MAX, VarLiteral::USED));
-    vars.insert(buffer->NameExpression(VarLiteral::MIN, VarLiteral::ALLOC));
-    vars.insert(buffer->NameExpression(VarLiteral::MAX, VarLiteral::ALLOC));
+    uint32_t usedMin = buffer->NameExpression(VarLiteral::MIN, VarLiteral::USED).Index();
+    sets.Union(usedMin, buffer->NameExpression(VarLiteral::MAX, VarLiteral::USED).Index());
+    sets.Union(usedMin, buffer->NameExpression(VarLiteral::MIN, VarLiteral::ALLOC).Index());
+    sets.Union(usedMin, buffer->NameExpression(VarLiteral::MAX, VarLiteral::ALLOC).Index());
+  }
+
+  // Components are numbered in the order of their first buffer, indexed by the set representative.
+  vector<int> componentOf(VarTable::Size(), -1);
+  vector<Component> components;
+  for (set<Buffer>::const_iterator buffer = buffers_.begin(); buffer != buffers_.end(); ++buffer) {
+    uint32_t root = sets.Find(buffer->NameExpression(VarLiteral::MIN, VarLiteral::USED).Index());
+    if (componentOf[root] == -1) {
+      componentOf[root] = components.size();
+      components.push_back(Component());
+    }
+    components[componentOf[root]].buffers_.push_back(*buffer);
+  }
+
+  Constraint::Type order[] = { Constraint::STRUCTURAL, Constraint::ALIASING, Constraint::NORMAL };
+  for (size_t t = 0; t < sizeof(order) / sizeof(order[0]); ++t) {
+    for (size_t row = 0; row < constraints_.Size(); ++row) {
+      if (constraints_.GetType(row) != order[t] ||
+          constraints_.RowBegin(row) == constraints_.RowEnd(row)) {
+        // Constant rows have no variables, and can not affect any buffer.
+        continue;
+      }
+      int c = componentOf[sets.Find(constraints_.Var(constraints_.RowBegin(row)).Index())];
+      if (c != -1) {
+        components[c].rows_.push_back(row);
+      }
+    }
   }
 
-  for (vector<Constraint>::const_iterator constraint = constraints_.begin();
-       constraint != constraints_.end();
-       ++constraint) {
-    constraint->GetVars(vars);
+  for (uint32_t var = 0; var < VarTable::Size(); ++var) {
+    int c = componentOf[sets.Find(var)];
+    if (c != -1) {
+      components[c].vars_.push_back(VarId(var));
+    }
   }
-  return vars;
+
+  for (size_t source = 0; source < constraints_.UnboundedSize(); ++source) {
+    int c = componentOf[sets.Find(constraints_.UnboundedVar(source).Index())];
+    if (c != -1) {
+      components[c].unbounded_.push_back(source);
+    }
+  }
+  return components;
+}
+
+/**
+  The index of var in the sorted vars.
+*/
+inline static uint32_t LocalIndex(const vector<VarId>& vars, VarId var) {
+  return lower_bound(vars.begin(), vars.end(), var) - vars.begin();
 }
 
+void ConstraintProblem::Presolve(Component* component) const {
+  ProfileScope scope("Presolve");
+  const vector<VarId>& vars = component->vars_;
+  const vector<size_t>& rows = component->rows_;
+  size_t n = vars.size();
+
+  // Buffer columns are the result, unbounded sources must stay columns of the problem.
+  vector<bool> keep(n, false);
+  for (vector<Buffer>::const_iterator b = component->buffers_.begin();
+       b != component->buffers_.end(); ++b) {
+    keep[LocalIndex(vars, b->FindExpression(VarLiteral::MIN, VarLiteral::USED))] = true;
+    keep[LocalIndex(vars, b->FindExpression(VarLiteral::MAX, VarLiteral::USED))] = true;
+    keep[LocalIndex(vars, b->FindExpression(VarLiteral::MIN, VarLiteral::ALLOC))] = true;
+    keep[LocalIndex(vars, b->FindExpression(VarLiteral::MAX, VarLiteral::ALLOC))] = true;
+  }
+  for (size_t i = 0; i < component->unbounded_.size(); ++i) {
+    keep[LocalIndex(vars, constraints_.UnboundedVar(component->unbounded_[i]))] = true;
+  }
+
+  // Dominated duplicates - of the rows of the same type with the same (scaled) coefficients, only
+  // the one with the smallest constant is needed.
+  typedef vector<std::pair<uint32_t, double> > Coefs;
+  map<std::pair<Constraint::Type, Coefs>, size_t> tightest;
+  vector<bool> alive(rows.size(), true);
+  for (size_t r = 0; r < rows.size(); ++r) {
+    size_t row = rows[r];
+    uint32_t begin = constraints_.RowBegin(row), end = constraints_.RowEnd(row);
+    double scale = fabs(constraints_.Coef(begin));
+    std::pair<Constraint::Type, Coefs> key(constraints_.GetType(row), Coefs());
+    for (uint32_t e = begin; e < end; ++e) {
+      key.second.push_back(std::make_pair(constraints_.Var(e).Index(),
+                                          constraints_.Coef(e) / scale));
+    }
+    map<std::pair<Constraint::Type, Coefs>, size_t>::iterator it = tightest.find(key);
+    if (it == tightest.end()) {
+      tightest[key] = r;
+      continue;
+    }
+    size_t other = rows[it->second];
+    double otherScale = fabs(constraints_.Coef(constraints_.RowBegin(other)));
+    if (constraints_.Left(row) / scale < constraints_.Left(other) / otherScale) {
+      alive[it->second] = false;
+      it->second = r;
+    } else {
+      alive[r] = false;
+    }
+  }
+
+  // Occurrences of each variable in the remaining rows, by the sign of its coefficient after
+  // negating the min variables (see SolveDifferences).
+  vector<vector<size_t> > rowsOf(n);
+  vector<int> positive(n, 0), negative(n, 0);
+  for (size_t r = 0; r < rows.size(); ++r) {
+    if (!alive[r]) {
+      continue;
+    }
+    for (uint32_t e = constraints_.RowBegin(rows[r]); e < constraints_.RowEnd(rows[r]); ++e) {
+      uint32_t v = LocalIndex(vars, constraints_.Var(e));
+      rowsOf[v].push_back(r);
+      if ((constraints_.Coef(e) > 0) == VarTable::IsMax(vars[v])) {
+        ++positive[v];
+      } else {
+        ++negative[v];
+      }
+    }
+  }
+
+  // A free variable which never bounds another variable (no positive coefficients) can grow until
+  // all its rows hold, and a variable of a single row can always make that row hold. Such rows
+  // never reach a buffer, are never part of an infeasable set, and are removed with the variable.
+  vector<bool> removed(n, false);
+  vector<uint32_t> pending;
+  for (uint32_t v = 0; v < n; ++v) {
+    pending.push_back(v);
+  }
+  while (!pending.empty()) {
+    uint32_t v = pending.back();
+    pending.pop_back();
+    if (keep[v] || removed[v] || (positive[v] > 0 && positive[v] + negative[v] > 1)) {
+      continue;
+    }
+    removed[v] = true;
+    for (size_t i = 0; i < rowsOf[v].size(); ++i) {
+      size_t r = rowsOf[v][i];
+      if (!alive[r]) {
+        continue;
+      }
+      alive[r] = false;
+      for (uint32_t e = constraints_.RowBegin(rows[r]); e < constraints_.RowEnd(rows[r]); ++e) {
+        uint32_t u = LocalIndex(vars, constraints_.Var(e));
+        if ((constraints_.Coef(e) > 0) == VarTable::IsMax(vars[u])) {
+          --positive[u];
+        } else {
+          --negative[u];
+        }
+        pending.push_back(u);
+      }
+    }
+  }
+
+  vector<size_t> keptRows;
+  for (size_t r = 0; r < rows.size(); ++r) {
+    if (alive[r]) {
+      keptRows.push_back(rows[r]);
+    }
+  }
+  vector<VarId> keptVars;
+  for (uint32_t v = 0; v < n; ++v) {
+    if (!removed[v]) {
+      keptVars.push_back(vars[v]);
+    }
+  }
+  Profiler::Count("presolve removed rows", rows.size() - keptRows.size());
+  Profiler::Count("presolve removed columns", n - keptVars.size());
+  LOG_DEBUG << "Presolve removed " << rows.size() - keptRows.size() << " of " << rows.size() <<
+      " rows and " << n - keptVars.size() << " of " << n << " columns" << endl;
+  component->rows_.swap(keptRows);
+  component->vars_.swap(keptVars);
+}
 
-inline static void MapVarToCol(const set<string>& vars, map<string, int>& varToCol /* out */,
-                               map<int, string>& colToVar /* out */) {
+inline static void MapVarToCol(const vector<VarId>& vars, vector<int>& varToCol /* out */,
+                               vector<VarId>& colToVar /* out */) {
+  varToCol.assign(VarTable::Size(), 0);
+  colToVar.assign(vars.size() + 1, VarId());
   int col = 1;
-  for (set<string>::const_iterator var = vars.begin(); var != vars.end(); ++var, ++col) {
-    varToCol[*var] = col;
+  for (vector<VarId>::const_iterator var = vars.begin(); var != vars.end(); ++var, ++col) {
+    varToCol[var->Index()] = col;
     colToVar[col] = *var;
   }
 }
 
-vector<Buffer> ConstraintProblem::Solve() const {
-  LOG << "Solving constraint problem (" << constraints_.size() << " constraints)" << endl;
-  
- vector<Buffer> emptySet;
- if (buffers_.empty()) {
-    LOG << "No buffers" << endl;
-    return emptySet;
+/**
+  Make a single component feasable and find its unsafe buffers.
+*/
+class ComponentSolveJob : public Job {
+  const ConstraintProblem& problem_;
+  bool save_;
+
+ public:
+  const ConstraintProblem::Component& component_;
+  vector<Buffer> unsafe_;
+  // Was the component solved by the DifferenceSolver?
+  bool graph_;
+  // The feasable problem, saved only if save is set and there are unsafe buffers.
+  LinearProblemSnapshot snapshot_;
+  bool saved_;
+
+  ComponentSolveJob(const ConstraintProblem& problem,
+                    const ConstraintProblem::Component& component, bool save) :
+    problem_(problem), save_(save), component_(component), graph_(false), saved_(false) {}
+
+  virtual void Run() {
+    graph_ = problem_.graphSolver_ && problem_.SolveDifferences(component_, &unsafe_);
+    if (graph_ && !(save_ && !unsafe_.empty())) {
+      return;
+    }
+    // glpk is needed for solving, or for blaming the unsafe buffers.
+    bool solved;
+    LinearProblem lp = problem_.MakeFeasableProblem(component_, &solved);
+    if (!solved) {
+      // Nothing is known about the buffers, so all of them may overrun. They can't be blamed.
+      Profiler::Count("unsolved components", 1);
+      if (!graph_) {
+        unsafe_ = component_.buffers_;
+      }
+      return;
+    }
+    if (!graph_) {
+      unsafe_ = problem_.SolveProblem(lp, component_.buffers_);
+    }
+    if (save_ && !unsafe_.empty()) {
+      lp.Save(&snapshot_);
+      saved_ = true;
+    }
+  }
+};
+
+/**
+  Blame a single unsafe buffer, on a private copy of its component's feasable problem.
+*/
+class BlameJob : public Job {
+  const ConstraintProblem& problem_;
+  const LinearProblemSnapshot& snapshot_;
+
+ public:
+  const Buffer buffer_;
+  vector<string> blame_;
+
+  BlameJob(const ConstraintProblem& problem, const LinearProblemSnapshot& snapshot,
+           const Buffer& buffer) :
+    problem_(problem), snapshot_(snapshot), buffer_(buffer) {}
+
+  virtual void Run() {
+    LinearProblem lp(snapshot_);
+    // Starts from the saved optimal basis, restores the solution without iterating.
+    lp.Solve();
+    blame_ = problem_.Blame(lp, buffer_);
+  }
+};
+
+/**
+  Pass the verdicts of each solved component to a ResultSink. With blames, the unsafe buffers of a
+  component are passed once their BlameJobs, which are added to the same pool, are done.
+*/
+class SolveObserver : public JobObserver {
+  const ConstraintProblem& problem_;
+  ResultSink* sink_;
+  bool blame_;
+  set<const Job*> blameJobs_;
+
+ public:
+  vector<Job*> added_;
+
+  SolveObserver(const ConstraintProblem& problem, ResultSink* sink, bool blame) :
+    problem_(problem), sink_(sink), blame_(blame) {}
+
+  ~SolveObserver() {
+    for (size_t i = 0; i < added_.size(); ++i) {
+      delete added_[i];
+    }
+  }
+
+  virtual void Done(Job* job, vector<Job*>* more) {
+    if (blameJobs_.count(job) != 0) {
+      BlameJob* blamed = static_cast<BlameJob*>(job);
+      sink_->Result(blamed->buffer_, true, blamed->blame_);
+      return;
+    }
+    const ComponentSolveJob* solved = static_cast<ComponentSolveJob*>(job);
+    set<Buffer> unsafe(solved->unsafe_.begin(), solved->unsafe_.end());
+    const vector<Buffer>& buffers = solved->component_.buffers_;
+    for (vector<Buffer>::const_iterator b = buffers.begin(); b != buffers.end(); ++b) {
+      if (unsafe.count(*b) == 0 || !solved->saved_) {
+        sink_->Result(*b, unsafe.count(*b) != 0, vector<string>());
+        continue;
+      }
+      BlameJob* blameJob = new BlameJob(problem_, solved->snapshot_, *b);
+      blameJobs_.insert(blameJob);
+      added_.push_back(blameJob);
+      more->push_back(blameJob);
+    }
   }
-  if (constraints_.empty()) {
-    LOG << "No constraints" << endl;
-    return emptySet;
+};
+
+/**
+  Collects the unsafe buffers, with their blames.
+*/
+class UnsafeSink : public ResultSink {
+ public:
+  map<Buffer, vector<string> > unsafe_;
+
+  virtual void Result(const Buffer& buffer, bool unsafe, const vector<string>& blame) {
+    if (unsafe) {
+      unsafe_[buffer] = blame;
+    }
   }
+};
 
-  return SolveProblem(MakeFeasableProblem());
+void ConstraintProblem::Solve(ResultSink* sink, bool blame) const {
+  LOG_INFO << "Solving constraint problem (" << constraints_.Size() << " constraints)" << endl;
+  if (buffers_.empty()) {
+    LOG_INFO << "No buffers" << endl;
+    return;
+  }
+  if (constraints_.Empty()) {
+    LOG_INFO << "No constraints" << endl;
+    for (set<Buffer>::const_iterator b = buffers_.begin(); b != buffers_.end(); ++b) {
+      sink->Result(*b, false, vector<string>());
+    }
+    return;
+  }
+
+  vector<Component> components = Decompose();
+  Profiler::Count("components", components.size());
+
+  vector<ComponentSolveJob*> jobs;
+  for (size_t i = 0; i < components.size(); ++i) {
+    jobs.push_back(new ComponentSolveJob(*this, components[i], blame));
+  }
+  {
+    SolveObserver observer(*this, sink, blame);
+    ThreadPool::Run(vector<Job*>(jobs.begin(), jobs.end()), jobs_, &observer);
+    if (blame) {
+      Profiler::Count("blame jobs", observer.added_.size());
+    }
+  }
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    Profiler::Count(jobs[i]->graph_ ? "graph components" : "glpk components", 1);
+    delete jobs[i];
+  }
+}
+
+vector<Buffer> ConstraintProblem::Solve() const {
+  UnsafeSink sink;
+  Solve(&sink, false);
+  // Ordered by buffer, the same as solving the whole problem at once
+  vector<Buffer> unsafeBuffers;
+  for (map<Buffer, vector<string> >::iterator it = sink.unsafe_.begin(); it != sink.unsafe_.end();
+       ++it) {
+    unsafeBuffers.push_back(it->first);
+  }
+  return unsafeBuffers;
 }
 
 inline void setBufferCoef(LinearProblem &p, const Buffer &b, double base) {
-  glp_set_obj_coef(p.lp_, p.varToCol_[b.NameExpression(VarLiteral::MIN, VarLiteral::USED )],  base);
-  glp_set_obj_coef(p.lp_, p.varToCol_[b.NameExpression(VarLiteral::MAX, VarLiteral::USED )], -base);
-  glp_set_obj_coef(p.lp_, p.varToCol_[b.NameExpression(VarLiteral::MIN, VarLiteral::ALLOC)],  base);
-  glp_set_obj_coef(p.lp_, p.varToCol_[b.NameExpression(VarLiteral::MAX, VarLiteral::ALLOC)], -base);
+  glp_set_obj_coef(p.lp_, p.Col(b.FindExpression(VarLiteral::MIN, VarLiteral::USED )),  base);
+  glp_set_obj_coef(p.lp_, p.Col(b.FindExpression(VarLiteral::MAX, VarLiteral::USED )), -base);
+  glp_set_obj_coef(p.lp_, p.Col(b.FindExpression(VarLiteral::MIN, VarLiteral::ALLOC)),  base);
+  glp_set_obj_coef(p.lp_, p.Col(b.FindExpression(VarLiteral::MAX, VarLiteral::ALLOC)), -base);
 }
 
-LinearProblem ConstraintProblem::MakeFeasableProblem() const {
-  set<string> vars = CollectVars();
+/**
+  Enable the objective of each buffer in turn, and disable it again if the problem becomes
+  unbounded.
+*/
+static void RemoveUnboundedOneByOne(LinearProblem &lp, const vector<Buffer>& buffers) {
+  for (vector<Buffer>::const_iterator b = buffers.begin(); b != buffers.end(); ++b) {
+    setBufferCoef(lp, *b, 0.0);
+  }
+  for (vector<Buffer>::const_iterator b = buffers.begin(); b != buffers.end(); ++b) {
+    setBufferCoef(lp, *b, 1.0);
+    if (lp.Solve() == GLP_UNBND) {
+      setBufferCoef(lp, *b, 0.0);
+    }
+  }
+}
+
+int ConstraintProblem::RemoveUnbounded(LinearProblem &lp, const vector<Buffer>& buffers) const {
+  ProfileScope scope("RemoveUnbounded");
+  vector<bool> bounded;
+  bool exact = lp.BoundedColumns(&bounded);
+
+  vector<Buffer> uncertain;
+  for (vector<Buffer>::const_iterator b = buffers.begin(); b != buffers.end(); ++b) {
+    if (bounded[lp.Col(b->FindExpression(VarLiteral::MIN, VarLiteral::USED))] &&
+        bounded[lp.Col(b->FindExpression(VarLiteral::MAX, VarLiteral::USED))] &&
+        bounded[lp.Col(b->FindExpression(VarLiteral::MIN, VarLiteral::ALLOC))] &&
+        bounded[lp.Col(b->FindExpression(VarLiteral::MAX, VarLiteral::ALLOC))]) {
+      setBufferCoef(lp, *b, 1.0);
+    } else {
+      setBufferCoef(lp, *b, 0.0);
+      if (!exact) {
+        uncertain.push_back(*b);
+      }
+    }
+  }
+  Profiler::Count("uncertain buffers", uncertain.size());
+
+  if (!uncertain.empty()) {
+    // Try all of them at once, and only test the buffers one by one if that is unbounded.
+    for (vector<Buffer>::const_iterator b = uncertain.begin(); b != uncertain.end(); ++b) {
+      setBufferCoef(lp, *b, 1.0);
+    }
+    if (lp.Solve() == GLP_UNBND) {
+      RemoveUnboundedOneByOne(lp, uncertain);
+    }
+  }
+  int status = lp.Solve();
+  if (status == GLP_UNBND) {
+    // Should not happen, unless the classification is wrong due to rounding.
+    LOG_ERROR << "Unbounded buffers misclassified, testing all buffers" << endl;
+    RemoveUnboundedOneByOne(lp, buffers);
+    status = lp.Solve();
+  }
+  return status;
+}
+
+LinearProblem ConstraintProblem::MakeFeasableProblem(const Component& original,
+                                                     bool* solved) const {
+  ProfileScope scope("MakeFeasableProblem");
+  // The presolved component keeps the store row numbers, so lp.rowOrigin_ maps the rows back for
+  // blaming.
+  Component component = original;
+  if (presolve_) {
+    Presolve(&component);
+  }
+  const vector<VarId>& vars = component.vars_;
+  const vector<size_t>& rows = component.rows_;
   LinearProblem lp;
   MapVarToCol(vars, lp.varToCol_, lp.colToVar_);
 
   glp_set_obj_dir(lp.lp_, GLP_MAX);
   glp_add_cols(lp.lp_, vars.size());
-  glp_add_rows(lp.lp_, constraints_.size());
   {
-    // Fill matrix
-    int row = 1;
-    for (vector<Constraint>::const_iterator c = constraints_.begin(); c != constraints_.end(); ++c) {
-      if (c->GetType() == Constraint::STRUCTURAL) {
-        c->AddToLPP(lp.lp_, row, lp.varToCol_);
-        ++row;
-      }     
-    }
-    lp.structuralRows_ = row - 1;
-    for (vector<Constraint>::const_iterator c = constraints_.begin(); c != constraints_.end(); ++c) {
-      if (c->GetType() == Constraint::ALIASING) {
-        c->AddToLPP(lp.lp_, row, lp.varToCol_);
-        ++row;
-      }     
-    }    
-    lp.aliasingRows_ = (row - 1) - lp.structuralRows_;
-    for (vector<Constraint>::const_iterator c = constraints_.begin(); c != constraints_.end(); ++c) {
-      if (c->GetType() == Constraint::NORMAL) {
-        c->AddToLPP(lp.lp_, row, lp.varToCol_);
-        ++row;
-      }     
-    }    
-    lp.realRows_ = row - lp.structuralRows_ - 1;
+    ProfileScope fillScope("FillMatrix");
+    Profiler::Count("rows", rows.size());
+    Profiler::Count("columns", vars.size());
+    // Fill matrix - the component rows are ordered structural rows first, then aliasing rows and
+    // then all the other rows.
+    int structural = 0, aliasing = 0;
+    lp.rowOrigin_.assign(1, 0);
+    for (size_t i = 0; i < rows.size(); ++i) {
+      if (constraints_.GetType(rows[i]) == Constraint::STRUCTURAL) {
+        ++structural;
+      } else if (constraints_.GetType(rows[i]) == Constraint::ALIASING) {
+        ++aliasing;
+      }
+      lp.rowOrigin_.push_back(rows[i]);
+    }
+    if (!rows.empty()) {
+      glp_add_rows(lp.lp_, rows.size());
+      constraints_.LoadMatrix(lp.lp_, rows, lp.varToCol_);
+    }
+
+    lp.structuralRows_ = structural;
+    lp.aliasingRows_ = aliasing;
+    lp.realRows_ = rows.size() - structural;
   }
 
   for (size_t i = 1; i <= vars.size(); ++i) {
     glp_set_col_bnds(lp.lp_, i, GLP_FR, 0.0, 0.0);
   }
+  for (size_t i = 0; i < component.unbounded_.size(); ++i) {
+    size_t source = component.unbounded_[i];
+    lp.SetUnbounded(lp.Col(constraints_.UnboundedVar(source)), -static_cast<int>(source) - 1);
+  }
 
-  for (set<Buffer>::const_iterator b = buffers_.begin(); b != buffers_.end(); ++b) {
+  const vector<Buffer>& buffers = component.buffers_;
+  for (vector<Buffer>::const_iterator b = buffers.begin(); b != buffers.end(); ++b) {
     // Set objective coeficients
     setBufferCoef(lp, *b, 1.0);
   }
 
   glp_smcp params;
   glp_init_smcp(&params);
-  glp_term_hook(&printToLog, NULL);
   if (outputGlpk_) {
     params.msg_lev = GLP_MSG_ALL;
   } else {
@@ -124,53 +776,56 @@ LinearProblem ConstraintProblem::MakeFeasableProblem() const {
   }
   lp.SetParams(params);
 
+  // Objective changes keep the basis primal feasable, so the unbounded buffers are removed with the
+  // primal simplex from the previous basis. Removing infeasable rows is followed by the dual
+  // simplex.
+  *solved = false;
   int status = lp.Solve();
   while (status != GLP_OPT) {
-    while (status == GLP_UNBND) {
-      for (set<Buffer>::const_iterator b = buffers_.begin(); b != buffers_.end(); ++b) {
-        setBufferCoef(lp, *b, 0.0);
-      }
-
-      for (set<Buffer>::const_iterator b = buffers_.begin(); b != buffers_.end(); ++b) {
-        setBufferCoef(lp, *b, 1.0);
-        status = lp.Solve();
-        if (status == GLP_UNBND) {
-          setBufferCoef(lp, *b, 0.0);
-        }
+    if (status == GLP_UNBND) {
+      status = RemoveUnbounded(lp, buffers);
+    } else if ((status == GLP_INFEAS) || (status == GLP_NOFEAS)) {
+      if (lp.RemoveInfeasable() == 0) {
+        LOG_ERROR << "No infeasable rows found, giving up on the problem" << endl;
+        return lp;
       }
-      status = lp.Solve();
-    }
-    while ((status == GLP_INFEAS) || (status == GLP_NOFEAS)) {
-      lp.RemoveInfeasable();
-      status = lp.Solve();
+      status = lp.SolveDual();
+    } else {
+      // glpk failed even from the standard basis (see LinearProblem::Solve).
+      LOG_ERROR << "glpk status " << status << ", giving up on the problem" << endl;
+      return lp;
     }
   }
 
+  *solved = true;
   return lp;
 }
 
-vector<Buffer> ConstraintProblem::SolveProblem(LinearProblem lp) const {  
+bool ConstraintProblem::CheckBuffer(const Buffer& buffer, double usedMin, double usedMax,
+                                    double allocMin, double allocMax) {
+  // Print result
+  LOG_DEBUG << buffer.getReadableName() << " " << buffer.getSourceLocation() << endl;
+  LOG_DEBUG << " Used  min\t = " << usedMin << endl;
+  LOG_DEBUG << " Used  max\t = " << usedMax << endl;
+  LOG_DEBUG << " Alloc min\t = " << allocMin << endl;
+  LOG_DEBUG << " Alloc max\t = " << allocMax << endl;
+  LOG_DEBUG << endl;
+
+  return (usedMax >= allocMin) || (usedMin < 0);
+}
+
+vector<Buffer> ConstraintProblem::SolveProblem(const LinearProblem& lp,
+                                               const vector<Buffer>& buffers) const {
+  ProfileScope scope("SolveProblem");
   vector<Buffer> unsafeBuffers;
   
-  for (set<Buffer>::const_iterator buffer = buffers_.begin(); buffer != buffers_.end(); ++buffer) {
-    // Print result
-    LOG << buffer->getReadableName() << " " << buffer->getSourceLocation() << endl;
-    LOG << " Used  min\t = " << glp_get_col_prim(
-        lp.lp_, lp.varToCol_[buffer->NameExpression(VarLiteral::MIN, VarLiteral::USED)]) << endl;
-    LOG << " Used  max\t = " << glp_get_col_prim(
-        lp.lp_, lp.varToCol_[buffer->NameExpression(VarLiteral::MAX, VarLiteral::USED)]) << endl;
-    LOG << " Alloc min\t = " << glp_get_col_prim(
-        lp.lp_, lp.varToCol_[buffer->NameExpression(VarLiteral::MIN, VarLiteral::ALLOC)]) << endl;
-    LOG << " Alloc max\t = " << glp_get_col_prim(
-        lp.lp_, lp.varToCol_[buffer->NameExpression(VarLiteral::MAX, VarLiteral::ALLOC)]) << endl;
-
-    LOG << endl;
-    if ((glp_get_col_prim(
-         lp.lp_, lp.varToCol_[buffer->NameExpression(VarLiteral::MAX, VarLiteral::USED)]) >=
-         glp_get_col_prim(
-         lp.lp_, lp.varToCol_[buffer->NameExpression(VarLiteral::MIN, VarLiteral::ALLOC)])) ||
-         (glp_get_col_prim(
-         lp.lp_, lp.varToCol_[buffer->NameExpression(VarLiteral::MIN, VarLiteral::USED)]) < 0)) {
+  for (vector<Buffer>::const_iterator buffer = buffers.begin(); buffer != buffers.end(); ++buffer) {
+    int usedMin = lp.Col(buffer->FindExpression(VarLiteral::MIN, VarLiteral::USED));
+    int usedMax = lp.Col(buffer->FindExpression(VarLiteral::MAX, VarLiteral::USED));
+    int allocMin = lp.Col(buffer->FindExpression(VarLiteral::MIN, VarLiteral::ALLOC));
+    int allocMax = lp.Col(buffer->FindExpression(VarLiteral::MAX, VarLiteral::ALLOC));
+    if (CheckBuffer(*buffer, lp.Value(usedMin), lp.Value(usedMax), lp.Value(allocMin),
+                    lp.Value(allocMax))) {
       unsafeBuffers.push_back(*buffer);
     }
   }
@@ -178,49 +833,133 @@ vector<Buffer> ConstraintProblem::SolveProblem(LinearProblem lp) const {
   return unsafeBuffers;
 }
 
-vector<string> ConstraintProblem::Blame(LinearProblem lp, Buffer &buffer) const {
+bool ConstraintProblem::SolveDifferences(const Component& component,
+                                         vector<Buffer>* unsafe) const {
+  ProfileScope scope("SolveDifferences");
+  const vector<VarId>& vars = component.vars_;
+  // Upper bounds (max) are minimized and lower bounds (min) are maximized. Negating the min
+  // variables turns this into minimizing all the variables, and keeps rows which relate two
+  // variables of the same direction difference constraints.
+  vector<double> sign(vars.size());
+  for (size_t i = 0; i < vars.size(); ++i) {
+    sign[i] = VarTable::IsMax(vars[i]) ? 1.0 : -1.0;
+  }
+
+  DifferenceSolver solver(vars.size());
+  uint32_t rowVars[2];
+  double rowCoefs[2];
+  for (size_t r = 0; r < component.rows_.size(); ++r) {
+    size_t row = component.rows_[r];
+    uint32_t begin = constraints_.RowBegin(row), size = constraints_.RowEnd(row) - begin;
+    if (size > 2) {
+      return false;
+    }
+    for (uint32_t i = 0; i < size; ++i) {
+      rowVars[i] = LocalIndex(vars, constraints_.Var(begin + i));
+      rowCoefs[i] = constraints_.Coef(begin + i) * sign[rowVars[i]];
+    }
+    if (!solver.AddRow(size, rowVars, rowCoefs, constraints_.Left(row))) {
+      return false;
+    }
+  }
+
+  // Unbounded variables are +infinity after the negation, which propagates along the edges exactly
+  // as LinearProblem::SetUnbounded does for difference constraints.
+  for (size_t i = 0; i < component.unbounded_.size(); ++i) {
+    solver.AddLowerBound(LocalIndex(vars, constraints_.UnboundedVar(component.unbounded_[i])),
+                         -DifferenceSolver::MinusInfinity());
+  }
+
+  if (!solver.Solve()) {
+    // Infeasable, glpk removes the infeasable rows.
+    return false;
+  }
+
+  const vector<Buffer>& buffers = component.buffers_;
+  VarLiteral::ExpressionDir dirs[] = { VarLiteral::MIN, VarLiteral::MAX };
+  VarLiteral::ExpressionType types[] = { VarLiteral::USED, VarLiteral::ALLOC };
+  // Values of the negated min variables are negated back.
+  vector<double> values;
+  for (vector<Buffer>::const_iterator buffer = buffers.begin(); buffer != buffers.end(); ++buffer) {
+    for (int t = 0; t < 2; ++t) {
+      for (int d = 0; d < 2; ++d) {
+        double value = solver.Value(LocalIndex(vars, buffer->FindExpression(dirs[d], types[t])));
+        if (value == DifferenceSolver::MinusInfinity()) {
+          // Unbounded objective, glpk drops the buffer from the objective.
+          return false;
+        }
+        values.push_back(dirs[d] == VarLiteral::MAX ? value : -value);
+      }
+    }
+  }
+
+  unsafe->clear();
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    if (CheckBuffer(buffers[i], values[4 * i], values[4 * i + 1], values[4 * i + 2],
+                    values[4 * i + 3])) {
+      unsafe->push_back(buffers[i]);
+    }
+  }
+  return true;
+}
+
+vector<string> ConstraintProblem::Blame(LinearProblem& lp, const Buffer &buffer) const {
+  ProfileScope scope("Blame");
   vector<string> result;
 
+  // An overrun caused by an unbounded variable is blamed on the rows the infinity propagated
+  // through, and on its source.
+  vector<int> rows, sources;
+  lp.UnboundedReasons(lp.Col(buffer.FindExpression(VarLiteral::MAX, VarLiteral::USED)), &rows,
+                      &sources);
+  lp.UnboundedReasons(lp.Col(buffer.FindExpression(VarLiteral::MIN, VarLiteral::USED)), &rows,
+                      &sources);
+  lp.UnboundedReasons(lp.Col(buffer.FindExpression(VarLiteral::MIN, VarLiteral::ALLOC)), &rows,
+                      &sources);
+  if (!rows.empty() || !sources.empty()) {
+    sort(sources.begin(), sources.end());
+    sources.erase(unique(sources.begin(), sources.end()), sources.end());
+    sort(rows.begin(), rows.end());
+    rows.erase(unique(rows.begin(), rows.end()), rows.end());
+    for (size_t i = 0; i < sources.size(); ++i) {
+      result.push_back(constraints_.UnboundedBlame(sources[i]).ToString());
+    }
+    for (size_t i = 0; i < rows.size(); ++i) {
+      result.push_back(constraints_.Blame(lp.rowOrigin_[rows[i]]).ToString());
+    }
+    return result;
+  }
+
   double minAlloc = glp_get_col_prim(lp.lp_, 
-                       lp.varToCol_[buffer.NameExpression(VarLiteral::MIN, VarLiteral::ALLOC)]) - 1;
-  glp_set_col_bnds(lp.lp_, lp.varToCol_[buffer.NameExpression(VarLiteral::MAX, VarLiteral::USED)],
+                       lp.Col(buffer.FindExpression(VarLiteral::MIN, VarLiteral::ALLOC))) - 1;
+  glp_set_col_bnds(lp.lp_, lp.Col(buffer.FindExpression(VarLiteral::MAX, VarLiteral::USED)),
                    GLP_UP, minAlloc, minAlloc);
-  glp_set_col_bnds(lp.lp_, lp.varToCol_[buffer.NameExpression(VarLiteral::MIN, VarLiteral::USED)],
+  glp_set_col_bnds(lp.lp_, lp.Col(buffer.FindExpression(VarLiteral::MIN, VarLiteral::USED)),
                    GLP_LO, 0.0, 0.0);
    
-  lp.Solve();
+  lp.SolveDual();
 
   // blame the interesting rows first
   lp.structuralRows_ += lp.aliasingRows_;
   lp.realRows_ = glp_get_num_rows(lp.lp_) - lp.structuralRows_;
-  vector<int> rows = lp.ElasticFilter();
+  rows = lp.FindIIS();
   for (size_t i = 0; i < rows.size(); ++i) {
-    char const *row = glp_get_row_name(lp.lp_, rows[i]);
-    if (row) {
-      result.push_back(row);
-    }
+    result.push_back(constraints_.Blame(lp.rowOrigin_[rows[i]]).ToString());
   }
-  
+
   // then aliasing rows too
   lp.structuralRows_ -= lp.aliasingRows_;
   lp.realRows_ = lp.aliasingRows_;
-  rows = lp.ElasticFilter();
+  rows = lp.FindIIS();
   for (size_t i = 0; i < rows.size(); ++i) {
-    char const *row = glp_get_row_name(lp.lp_, rows[i]);
-    if (row) {
-      result.push_back(row);
-    }
+    result.push_back(constraints_.Blame(lp.rowOrigin_[rows[i]]).ToString());
   }
   return result;
 }
 
 map<Buffer, vector<string> > ConstraintProblem::SolveAndBlame() const {
-  LinearProblem lp = MakeFeasableProblem();
-  vector<Buffer> unsafe = SolveProblem(lp);
-  map<Buffer, vector<string> > result;
-  for (size_t i = 0; i < unsafe.size(); ++i) {
-    result[unsafe[i]] = Blame(lp, unsafe[i]);
-  }
-  return result;
+  UnsafeSink sink;
+  Solve(&sink, true);
+  return sink.unsafe_;
 }
 } // namespace boa
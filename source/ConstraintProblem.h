@@ -1,31 +1,171 @@
 #ifndef __BOA_CONSTRAINT_PROBLEM_H__
 #define __BOA_CONSTRAINT_PROBLEM_H__
 
+#include <map>
+#include <string>
 #include <vector>
 
 #include "Constraint.h"
+#include "ConstraintStore.h"
 #include "LinearProblem.h"
+#include "Projection.h"
+#include "ThreadPool.h"
 
+using std::map;
+using std::string;
 using std::vector;
 
 namespace boa {
 
+/**
+  Receives the verdicts of ConstraintProblem::Solve, those of each component as soon as it is
+  solved. Calls are serialized, but may come from the solver's worker threads.
+*/
+class ResultSink {
+ public:
+  virtual ~ResultSink() {}
+
+  /**
+    buffer may be overrun if unsafe. blame - the constraints which cause the overrun, when blames
+    were requested (see ConstraintProblem::SolveAndBlame).
+  */
+  virtual void Result(const Buffer& buffer, bool unsafe, const vector<string>& blame) = 0;
+};
+
 class ConstraintProblem {
  private:
-  const vector<Constraint> NO_CONSTRAINTS;
-  vector<Constraint> constraints_;
+  /**
+    An independent part of the problem - buffers and rows which share no variables with the rest of
+    the problem, and can be solved on their own.
+  */
+  struct Component {
+    // Store rows, structural rows first, then aliasing rows and then all the other rows.
+    vector<size_t> rows_;
+    vector<Buffer> buffers_;
+    // Ordered by id
+    vector<VarId> vars_;
+    // Unbounded sources of the ConstraintStore
+    vector<size_t> unbounded_;
+  };
+
+  /**
+    A function with a body. Its parameters and return value are the interface of the function, at
+    every call site they are represented by other nodes - the "instances" of the interface.
+  */
+  struct Function {
+    // Store rows [firstRow_, endRow_) are the body of the function.
+    size_t firstRow_;
+    size_t endRow_;
+    // Nodes of the parameters and of the return value.
+    vector<const void*> interface_;
+  };
+
+  struct CallSite {
+    // Index of the calling function, -1 outside of any function.
+    int caller_;
+    const void* callee_;
+    // Interface node of the callee -> its instance at this call site.
+    map<const void*, const void*> instances_;
+    BlameInfo blame_;
+  };
+
+  friend class ComponentSolveJob;
+  friend class BlameJob;
+
+  ConstraintStore constraints_;
   set<Buffer> buffers_;
   bool outputGlpk_;
+  int jobs_;
+  bool graphSolver_;
+  bool presolve_;
+  bool summaries_;
+  vector<Function> functions_;
+  map<const void*, size_t> functionIndex_;
+  vector<CallSite> callSites_;
 
-  set<string> CollectVars() const;
+  /**
+    Split the problem into connected components of the variable/row graph.
 
-  vector<Buffer> SolveProblem(LinearProblem lp) const;
+    Rows and variables which are not connected to any buffer can not affect the result, and are not
+    part of any component.
 
-  vector<string> Blame(LinearProblem lp, Buffer &buffer) const;
+    Interns the USED and ALLOC bounds of every buffer. The jobs solving the components run in
+    parallel and must not intern, they look the buffer variables up with FindExpression.
+  */
+  vector<Component> Decompose() const;
+
+  /**
+    Shrink a component before it is loaded into glpk.
+
+    Removes dominated duplicate rows, and the variables which can always make their rows hold -
+    variables of a single row and variables which never bound another variable - together with
+    their rows. Buffer variables and unbounded sources are kept. Only whole rows are removed, the
+    remaining rows keep their store numbers, which map the solution and the blame back.
+  */
+  void Presolve(Component* component /* in, out */) const;
+
+  /**
+    Log the bounds of a buffer, and return true if it may overrun.
+  */
+  static bool CheckBuffer(const Buffer& buffer, double usedMin, double usedMax, double allocMin,
+                          double allocMax);
+
+  vector<Buffer> SolveProblem(const LinearProblem& lp, const vector<Buffer>& buffers) const;
+
+  /**
+    Solve a component with the DifferenceSolver, when all its rows are difference constraints.
+
+    Return false if the component has other rows, is infeasable or has a buffer whose bounds are
+    unbounded. Such components are left for glpk, which also repairs them - the graph solver is
+    only used where its verdicts are exactly those of the linear problem.
+  */
+  bool SolveDifferences(const Component& component, vector<Buffer>* unsafe /* out */) const;
+
+  /**
+    Blame the overrun of buffer, lp must be the solved problem of the buffer's component. lp is
+    modified.
+  */
+  vector<string> Blame(LinearProblem& lp, const Buffer &buffer) const;
   
-  LinearProblem MakeFeasableProblem() const;
+  /**
+    Remove the buffers whose objective is unbounded from the objective of lp, and solve it.
+
+    The buffers are classified by LinearProblem::BoundedColumns. When some rows are not difference
+    constraints the unclassified buffers are tried together, and one by one if that is unbounded.
+  */
+  int RemoveUnbounded(LinearProblem &lp, const vector<Buffer>& buffers) const;
+
+  /**
+    Load a component into glpk and solve it, removing the unbounded buffers from the objective and
+    the infeasable rows. solved is cleared if glpk gave up on the problem, its solution is
+    meaningless then.
+  */
+  LinearProblem MakeFeasableProblem(const Component& original, bool* solved /* out */) const;
+
+  /**
+    Project the body of function onto its interface and the variables it shares with the rest of
+    the problem (see Summarize). sites are the call sites in the body whose callee was summarized,
+    owner is the function whose body has all the rows of each variable, and bound maps the
+    instances of the other call sites to the callee's interface. Return false if the function can
+    not be summarized.
+  */
+  bool SummarizeFunction(size_t function, const vector<size_t>& sites, const vector<int>& owner,
+                         const vector<vector<Projection::Row> >& summaries,
+                         const map<const void*, const void*>& bound,
+                         vector<Projection::Row>* summary /* out */) const;
  public:
-  ConstraintProblem(bool output_glpk) : outputGlpk_(output_glpk) {}
+  /**
+    jobs is the number of threads used for solving and blaming, 0 for the number of processors.
+    graph_solver enables the DifferenceSolver, otherwise every component is solved with glpk.
+    presolve enables Presolve before loading a component into glpk. summaries enables the function
+    summaries of Summarize.
+  */
+  ConstraintProblem(bool output_glpk, int jobs = 0, bool graph_solver = true,
+                    bool presolve = true, bool summaries = true) :
+    outputGlpk_(output_glpk), jobs_(jobs ? jobs : ThreadPool::DefaultThreads()),
+    graphSolver_(graph_solver), presolve_(presolve), summaries_(summaries) {}
+
+  virtual ~ConstraintProblem() {}
 
   void AddBuffer(const Buffer& buffer) {
     buffers_.insert(buffer);
@@ -33,12 +173,52 @@ class ConstraintProblem {
 
   // Virtual because this method is overridden by the test class MockConstraintProblem.
   virtual void AddConstraint(const Constraint& c) {
-    constraints_.push_back(c);
+    constraints_.Add(c);
+  }
+
+  /**
+    Make var unbounded - +infinity if it is a max variable, -infinity if it is a min variable.
+  */
+  void AddUnbounded(VarId var, const BlameInfo& blame) {
+    constraints_.AddUnbounded(var, blame);
   }
 
+  /**
+    The rows added until EndFunction are the body of function. interface are the nodes of its
+    parameters and of its return value.
+  */
+  void BeginFunction(const void* function, const vector<const void*>& interface);
+
+  void EndFunction();
+
+  /**
+    A call of callee from the body of the current function. instances maps every interface node of
+    callee to the node which represents it at this call site, the rows binding the arguments and
+    the result are generated with the instances.
+  */
+  void AddCallSite(const void* callee, const map<const void*, const void*>& instances,
+                   const BlameInfo& blame);
+
+  /**
+    Replace function bodies with per call site summaries. Call once all the rows were added.
+
+    Functions are summarized bottom-up - the body of a function, with the summaries of the
+    functions it calls instantiated at their call sites, is projected (see Projection) onto its
+    interface and the variables it shares with the rest of the problem (buffers, globals, unbounded
+    sources). The body is then removed, and the summary is instantiated at each call site with the
+    interface renamed to the instances of the call site. A function is not summarized if it is
+    recursive, is never called, uses its interface outside of its body or if the projection has
+    more rows than the body. The call sites of such a function are bound to its interface, the
+    same as without summaries. The functions and call sites are forgotten, only the rows are left.
+  */
+  void Summarize();
+
   void Clear() {
     buffers_.clear();
-    constraints_.clear();
+    constraints_.Clear();
+    functions_.clear();
+    functionIndex_.clear();
+    callSites_.clear();
   }
   
   int BuffersCount() const {
@@ -52,6 +232,12 @@ class ConstraintProblem {
   */
   vector<Buffer> Solve() const;
 
+  /**
+    Solve the constraint problem, and pass the verdict of every buffer to sink as soon as the
+    component of the buffer is solved (and blamed, if blame is set).
+  */
+  void Solve(ResultSink* sink, bool blame) const;
+
   /**
     Solve the constraint problem and generate a minimal set of constraints which cause each overrun
 
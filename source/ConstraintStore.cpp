@@ -0,0 +1,69 @@
+#include "ConstraintStore.h"
+
+namespace boa {
+
+void ConstraintStore::Add(const Constraint& c) {
+  Add(c.literals_, c.left_, c.type_, c.blame_);
+}
+
+void ConstraintStore::Add(const map<VarId, double>& coefs, double left, Constraint::Type type,
+                          const BlameInfo& blame) {
+  for (map<VarId, double>::const_iterator it = coefs.begin(); it != coefs.end(); ++it) {
+    if (it->second != 0) {
+      vars_.push_back(it->first);
+      coefs_.push_back(it->second);
+    }
+  }
+  rowStart_.push_back(vars_.size());
+  left_.push_back(left);
+  types_.push_back(type);
+  blames_.push_back(blame);
+}
+
+void ConstraintStore::AddUnbounded(VarId var, const BlameInfo& blame) {
+  unbounded_.push_back(var);
+  unboundedBlames_.push_back(blame);
+}
+
+void ConstraintStore::GetVars(vector<bool>& vars) const {
+  for (vector<VarId>::const_iterator it = vars_.begin(); it != vars_.end(); ++it) {
+    vars[it->Index()] = true;
+  }
+}
+
+void ConstraintStore::LoadMatrix(glp_prob *lp, const vector<size_t>& rows,
+                                 const vector<int>& varToCol) const {
+  size_t nonZeros = 0;
+  for (size_t i = 0; i < rows.size(); ++i) {
+    nonZeros += RowEnd(rows[i]) - RowBegin(rows[i]);
+  }
+
+  // glpk ignores the 0's index of the arrays
+  vector<int> ia(nonZeros + 1), ja(nonZeros + 1);
+  vector<double> ar(nonZeros + 1);
+
+  size_t next = 1;
+  for (size_t i = 0; i < rows.size(); ++i) {
+    size_t row = rows[i];
+    for (uint32_t e = RowBegin(row); e < RowEnd(row); ++e, ++next) {
+      ia[next] = i + 1;
+      ja[next] = varToCol[vars_[e].Index()];
+      ar[next] = coefs_[e];
+    }
+    glp_set_row_bnds(lp, i + 1, GLP_UP, 0.0, left_[row]);
+  }
+  glp_load_matrix(lp, nonZeros, &ia[0], &ja[0], &ar[0]);
+}
+
+void ConstraintStore::Clear() {
+  rowStart_.assign(1, 0);
+  vars_.clear();
+  coefs_.clear();
+  left_.clear();
+  types_.clear();
+  blames_.clear();
+  unbounded_.clear();
+  unboundedBlames_.clear();
+}
+
+}  // namespace boa
@@ -0,0 +1,145 @@
+#ifndef __BOA_CONSTRAINTSTORE_H
+#define __BOA_CONSTRAINTSTORE_H /* */
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include <glpk.h>
+
+#include "Constraint.h"
+#include "VarTable.h"
+
+using std::string;
+using std::vector;
+
+namespace boa {
+
+/**
+  Compact storage of all the constraints of a problem.
+
+  Rows are kept in compressed sparse row (CSR) form - the variables and coefficients of all the rows
+  are stored in two contiguous arrays, and row i occupies the range [RowBegin(i), RowEnd(i)) of these
+  arrays. The constant side ("left"), the type and the blame of each row are kept in arrays of their
+  own. Blames are not passed to glpk, use Blame(row) to get the blame of an lp row's origin.
+
+  A Constraint is only used to build a single row, Add() copies it into the store.
+
+  Unbounded variables are not rows - AddUnbounded() records the variable and its blame as an
+  "unbounded source", and the solver treats its value as infinite (see
+  LinearProblem::SetUnbounded).
+*/
+class ConstraintStore {
+  // rowStart_[i] is the first element of row i, rowStart_[Size()] is the number of non zeros.
+  vector<uint32_t> rowStart_;
+  vector<VarId> vars_;
+  vector<double> coefs_;
+  vector<double> left_;
+  vector<Constraint::Type> types_;
+  vector<BlameInfo> blames_;
+  vector<VarId> unbounded_;
+  vector<BlameInfo> unboundedBlames_;
+
+ public:
+  ConstraintStore() : rowStart_(1, 0) {}
+
+  /**
+    Append a row. Zero coefficients are not stored.
+  */
+  void Add(const Constraint& c);
+
+  /**
+    Append the row left >= sum of coefs[var] * var.
+  */
+  void Add(const map<VarId, double>& coefs, double left, Constraint::Type type,
+           const BlameInfo& blame);
+
+  /**
+    Number of rows
+  */
+  size_t Size() const {
+    return left_.size();
+  }
+
+  bool Empty() const {
+    return left_.empty();
+  }
+
+  /**
+    Number of non zero coefficients in all rows
+  */
+  size_t NonZeros() const {
+    return vars_.size();
+  }
+
+  uint32_t RowBegin(size_t row) const {
+    return rowStart_[row];
+  }
+
+  uint32_t RowEnd(size_t row) const {
+    return rowStart_[row + 1];
+  }
+
+  VarId Var(uint32_t element) const {
+    return vars_[element];
+  }
+
+  double Coef(uint32_t element) const {
+    return coefs_[element];
+  }
+
+  /**
+    The constant C of the row C >= aX + bY ...
+  */
+  double Left(size_t row) const {
+    return left_[row];
+  }
+
+  Constraint::Type GetType(size_t row) const {
+    return types_[row];
+  }
+
+  const BlameInfo& Blame(size_t row) const {
+    return blames_[row];
+  }
+
+  /**
+    Record that var is unbounded - +infinity for a max variable, -infinity for a min variable.
+  */
+  void AddUnbounded(VarId var, const BlameInfo& blame);
+
+  /**
+    Number of unbounded sources
+  */
+  size_t UnboundedSize() const {
+    return unbounded_.size();
+  }
+
+  VarId UnboundedVar(size_t source) const {
+    return unbounded_[source];
+  }
+
+  const BlameInfo& UnboundedBlame(size_t source) const {
+    return unboundedBlames_[source];
+  }
+
+  /**
+    Mark the variables used by any of the rows in "vars", which is indexed by VarId.
+  */
+  void GetVars(vector<bool>& vars) const;
+
+  /**
+    Load the given rows into lp in a single pass.
+
+    Row rows[i] of the store becomes row i+1 of lp, and variable v becomes column varToCol[v]. lp
+    must already have enough rows and columns.
+  */
+  void LoadMatrix(glp_prob *lp, const vector<size_t>& rows, const vector<int>& varToCol) const;
+
+  void Clear();
+};
+
+}  // namespace boa
+
+#endif  // __BOA_CONSTRAINTSTORE_H
@@ -0,0 +1,188 @@
+#include "DifferenceSolver.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+using std::max;
+using std::min;
+using std::pair;
+
+namespace boa {
+
+double DifferenceSolver::MinusInfinity() {
+  return -std::numeric_limits<double>::infinity();
+}
+
+DifferenceSolver::DifferenceSolver(size_t vars) :
+  lower_(vars, MinusInfinity()), upper_(vars, std::numeric_limits<double>::infinity()),
+  edges_(vars) {}
+
+void DifferenceSolver::AddUpperBound(uint32_t var, double bound) {
+  upper_[var] = min(upper_[var], bound);
+}
+
+void DifferenceSolver::AddLowerBound(uint32_t var, double bound) {
+  lower_[var] = max(lower_[var], bound);
+}
+
+void DifferenceSolver::AddDifference(uint32_t x, uint32_t y, double c) {
+  edges_[x].push_back(Edge(y, -c));
+}
+
+bool DifferenceSolver::AddRow(size_t size, const uint32_t* vars, const double* coefs, double left) {
+  if (size == 0) {
+    return true;
+  }
+  if (size == 1) {
+    if (coefs[0] > 0) {
+      AddUpperBound(vars[0], left / coefs[0]);
+    } else if (coefs[0] < 0) {
+      AddLowerBound(vars[0], left / coefs[0]);
+    }
+    return true;
+  }
+  if (size == 2) {
+    if (coefs[0] == 1.0 && coefs[1] == -1.0) {
+      AddDifference(vars[0], vars[1], left);
+      return true;
+    }
+    if (coefs[0] == -1.0 && coefs[1] == 1.0) {
+      AddDifference(vars[1], vars[0], left);
+      return true;
+    }
+  }
+  return false;
+}
+
+void DifferenceSolver::FindComponents(vector<uint32_t>& component, vector<uint32_t>& members,
+                                      vector<uint32_t>& start) const {
+  const uint32_t NONE = ~0u;
+  size_t n = edges_.size();
+  vector<uint32_t> index(n, NONE), low(n, 0);
+  vector<bool> onStack(n, false);
+  vector<uint32_t> stack;
+  // Iterative Tarjan - the (variable, next edge) pairs of the recursion.
+  vector<pair<uint32_t, size_t> > calls;
+  uint32_t counter = 0;
+
+  component.assign(n, NONE);
+  members.clear();
+  start.assign(1, 0);
+  for (uint32_t root = 0; root < n; ++root) {
+    if (index[root] != NONE) {
+      continue;
+    }
+    index[root] = low[root] = counter++;
+    stack.push_back(root);
+    onStack[root] = true;
+    calls.push_back(std::make_pair(root, 0));
+    while (!calls.empty()) {
+      uint32_t v = calls.back().first;
+      if (calls.back().second < edges_[v].size()) {
+        uint32_t w = edges_[v][calls.back().second++].to_;
+        if (index[w] == NONE) {
+          index[w] = low[w] = counter++;
+          stack.push_back(w);
+          onStack[w] = true;
+          calls.push_back(std::make_pair(w, 0));
+        } else if (onStack[w]) {
+          low[v] = min(low[v], index[w]);
+        }
+        continue;
+      }
+      calls.pop_back();
+      if (!calls.empty()) {
+        uint32_t parent = calls.back().first;
+        low[parent] = min(low[parent], low[v]);
+      }
+      if (low[v] == index[v]) {
+        uint32_t c = start.size() - 1;
+        uint32_t w;
+        do {
+          w = stack.back();
+          stack.pop_back();
+          onStack[w] = false;
+          component[w] = c;
+          members.push_back(w);
+        } while (w != v);
+        start.push_back(members.size());
+      }
+    }
+  }
+}
+
+bool DifferenceSolver::Solve() {
+  vector<uint32_t> component, members, start;
+  FindComponents(component, members, start);
+
+  value_ = lower_;
+  vector<double> potential(edges_.size(), 0.0);
+  // Reverse topological order, so all the edges into a component are relaxed before it is solved.
+  for (uint32_t c = start.size() - 1; c-- > 0;) {
+    uint32_t begin = start[c], end = start[c + 1], size = end - begin;
+    bool cyclic = (size > 1);
+    for (size_t e = 0; !cyclic && e < edges_[members[begin]].size(); ++e) {
+      cyclic = (edges_[members[begin]][e].to_ == members[begin]);
+    }
+
+    if (cyclic) {
+      // Bellman-Ford from zero potentials, a change after "size" rounds means a positive cycle.
+      for (uint32_t round = 0; ; ++round) {
+        bool changed = false;
+        for (uint32_t m = begin; m < end; ++m) {
+          uint32_t v = members[m];
+          for (size_t e = 0; e < edges_[v].size(); ++e) {
+            const Edge& edge = edges_[v][e];
+            if (component[edge.to_] == c && potential[v] + edge.weight_ > potential[edge.to_]) {
+              potential[edge.to_] = potential[v] + edge.weight_;
+              changed = true;
+            }
+          }
+        }
+        if (!changed) {
+          break;
+        }
+        if (round >= size) {
+          return false;
+        }
+      }
+      // No positive cycles - longest paths converge within "size" rounds.
+      for (uint32_t round = 0; round < size; ++round) {
+        bool changed = false;
+        for (uint32_t m = begin; m < end; ++m) {
+          uint32_t v = members[m];
+          for (size_t e = 0; e < edges_[v].size(); ++e) {
+            const Edge& edge = edges_[v][e];
+            if (component[edge.to_] == c && value_[v] + edge.weight_ > value_[edge.to_]) {
+              value_[edge.to_] = value_[v] + edge.weight_;
+              changed = true;
+            }
+          }
+        }
+        if (!changed) {
+          break;
+        }
+      }
+    }
+
+    for (uint32_t m = begin; m < end; ++m) {
+      uint32_t v = members[m];
+      for (size_t e = 0; e < edges_[v].size(); ++e) {
+        const Edge& edge = edges_[v][e];
+        if (component[edge.to_] != c) {
+          value_[edge.to_] = max(value_[edge.to_], value_[v] + edge.weight_);
+        }
+      }
+    }
+  }
+
+  for (size_t v = 0; v < value_.size(); ++v) {
+    if (value_[v] > upper_[v]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace boa
@@ -0,0 +1,87 @@
+#ifndef __BOA_DIFFERENCESOLVER_H
+#define __BOA_DIFFERENCESOLVER_H /* */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+using std::vector;
+
+namespace boa {
+
+/**
+  Solver for systems of difference constraints - x - y <= c, x <= c and x >= c.
+
+  The feasable solutions of such a system are closed under component-wise minimum, so when every
+  variable is bounded from below there is a single least solution, which minimizes every variable
+  at once. It is computed as longest paths in the constraint graph, where x - y <= c is the edge
+  x -> y with weight -c (y >= x - c) and lower bounds are the initial values.
+
+  The graph is split into strongly connected components (Tarjan), which are processed in
+  topological order. Edges between components are relaxed once, Bellman-Ford is only needed inside
+  non trivial components, where it also detects positive cycles (infeasable systems).
+*/
+class DifferenceSolver {
+ public:
+  explicit DifferenceSolver(size_t vars);
+
+  /**
+    var <= bound
+  */
+  void AddUpperBound(uint32_t var, double bound);
+
+  /**
+    var >= bound
+  */
+  void AddLowerBound(uint32_t var, double bound);
+
+  /**
+    x - y <= c
+  */
+  void AddDifference(uint32_t x, uint32_t y, double c);
+
+  /**
+    Add the row left >= coefs[0] * vars[0] + ... + coefs[size-1] * vars[size-1], if it is a bound
+    or a difference constraint. Return false (and add nothing) otherwise.
+  */
+  bool AddRow(size_t size, const uint32_t* vars, const double* coefs, double left);
+
+  /**
+    Compute the least solution. Return false if the system is infeasable.
+  */
+  bool Solve();
+
+  /**
+    The least value of var in any feasable solution, -infinity if var is not bounded from below.
+    Valid after Solve() returned true.
+  */
+  double Value(uint32_t var) const {
+    return value_[var];
+  }
+
+  static double MinusInfinity();
+
+ private:
+  struct Edge {
+    uint32_t to_;
+    double weight_;
+
+    Edge(uint32_t to, double weight) : to_(to), weight_(weight) {}
+  };
+
+  vector<double> lower_, upper_, value_;
+  // Outgoing edges of each variable
+  vector<vector<Edge> > edges_;
+
+  /**
+    Find the strongly connected components. The variables of component c are
+    members[start[c]..start[c+1]), components are numbered in reverse topological order.
+  */
+  void FindComponents(vector<uint32_t>& component /* out */, vector<uint32_t>& members /* out */,
+                      vector<uint32_t>& start /* out */) const;
+};
+
+}  // namespace boa
+
+#endif  // __BOA_DIFFERENCESOLVER_H
@@ -1,5 +1,7 @@
 #include "Helpers.h"
 
+#include <stdio.h>
+
 #include <set>
 #include <sstream>
 #include <string>
@@ -38,6 +40,39 @@ namespace Helpers {
     }
     return result;
   }
+
+  string JsonString(const string &str) {
+    string result = "\"";
+    for (size_t i = 0; i < str.size(); ++i) {
+      unsigned char c = str[i];
+      if (c == '"' || c == '\\') {
+        result += '\\';
+        result += c;
+      } else if (c == '\n') {
+        result += "\\n";
+      } else if (c < 0x20) {
+        char escaped[7];
+        snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+        result += escaped;
+      } else {
+        result += c;
+      }
+    }
+    return result + "\"";
+  }
+
+  uint64_t Hash(const string &str, uint64_t seed) {
+    return HashBytes(str.data(), str.size(), seed);
+  }
+
+  uint64_t HashBytes(const char *data, size_t size, uint64_t seed) {
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; ++i) {
+      hash ^= static_cast<unsigned char>(data[i]);
+      hash *= 0x100000001b3ULL;
+    }
+    return hash;
+  }
 }  // namespace Helpers
 
 }  // namespace boa
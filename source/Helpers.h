@@ -1,6 +1,9 @@
 #ifndef __BOA_HELPERS_H
 #define __BOA_HELPERS_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <set>
 #include <sstream>
 #include <string>
@@ -36,6 +39,24 @@ namespace Helpers {
    * Splits str by the character c.
    */
   set<string> SplitString(const string &str, char c);
+
+  /**
+   * str as a quoted JSON string.
+   */
+  string JsonString(const string &str);
+
+  static const uint64_t HASH_SEED = 0xcbf29ce484222325ULL;
+
+  /**
+   * 64 bit FNV-1a hash of str. Hashing continues from seed, so
+   * Hash(a + b) == Hash(b, Hash(a)).
+   */
+  uint64_t Hash(const string &str, uint64_t seed = HASH_SEED);
+
+  /**
+   * Hash of the size bytes at data, the same as Hash of them as a string.
+   */
+  uint64_t HashBytes(const char *data, size_t size, uint64_t seed = HASH_SEED);
 }  // namespace Helpers
 
 }  // namespace boa
@@ -11,9 +11,11 @@ namespace boa {
    public:
 
     Integer(const Value* node) : VarLiteral(node) {}
+    // The value at a specific use of an operand, such as a parameter at a call site.
+    explicit Integer(const Use* use) : VarLiteral(use) {}
 
-    string NameExpression(ExpressionDir dir, ExpressionType type = USED) const {
-      return getUniqueName() + "!" + DirToString(dir);
+    VarId NameExpression(ExpressionDir dir, ExpressionType type = USED) const {
+      return VarTable::Intern(ValueNode_, isTmp_, VarTable::NO_TYPE, dir);
     }
   };
 }
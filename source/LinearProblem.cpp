@@ -1,5 +1,9 @@
 #include "LinearProblem.h"
 
+#include "DifferenceSolver.h"
+
+#include <math.h>
+
 #include <vector>
 #include <map>
 #include <algorithm>
@@ -9,7 +13,64 @@ using std::map;
 using std::sort;
 
 namespace boa {
-vector<int> LinearProblem::ElasticFilter() const {
+
+bool LinearProblem::coldStart_ = false;
+bool LinearProblem::batchRepair_ = true;
+const double LinearProblem::EPSILON = 1e-9;
+
+/**
+ * A printing function for GLPK.
+ *
+ * @see { glpk.pdf / glp_term_hook }
+ *
+ * glpk keeps the hook in its (per thread) environment, so it is installed before each solve.
+ */
+static int printToLog(void *info, const char *s) {
+  if (log::enabled(log::Info)) {
+    log::os() << s;
+  }
+  return 1;  // Non zero.
+}
+
+static void CopyRowBounds(glp_prob* from, glp_prob* to, int row) {
+  glp_set_row_bnds(to, row, glp_get_row_type(from, row), glp_get_row_lb(from, row),
+                   glp_get_row_ub(from, row));
+}
+
+static void CopyRowBounds(glp_prob* from, glp_prob* to, const vector<int>& rows, size_t begin,
+                          size_t end) {
+  for (size_t i = begin; i < end; ++i) {
+    CopyRowBounds(from, to, rows[i]);
+  }
+}
+
+void LinearProblem::QuickXplain(LinearProblem& tmp, const vector<int>& candidates, size_t begin,
+                                size_t end, bool checkBase, vector<int>* iis, int* solves) const {
+  if (checkBase) {
+    ++*solves;
+    if (!IsFeasable(tmp.SolveDual())) {
+      return;
+    }
+  }
+  if (end - begin == 1) {
+    CopyRowBounds(lp_, tmp.lp_, candidates[begin]);
+    iis->push_back(candidates[begin]);
+    return;
+  }
+  size_t middle = begin + (end - begin) / 2;
+  // The second half's conflict with the first half enabled, then the first half's conflict with
+  // it.
+  CopyRowBounds(lp_, tmp.lp_, candidates, begin, middle);
+  size_t found = iis->size();
+  QuickXplain(tmp, candidates, middle, end, true, iis, solves);
+  for (size_t i = begin; i < middle; ++i) {
+    glp_set_row_bnds(tmp.lp_, candidates[i], GLP_FR, 0.0, 0.0);
+  }
+  QuickXplain(tmp, candidates, begin, middle, iis->size() > found, iis, solves);
+}
+
+vector<int> LinearProblem::FindIIS(bool disjoint) const {
+  ProfileScope scope("FindIIS");
   LinearProblem tmp(*this);
 
   int realCols = glp_get_num_cols(tmp.lp_);
@@ -17,57 +78,284 @@ vector<int> LinearProblem::ElasticFilter() const {
     glp_set_obj_coef(tmp.lp_, i,  0);
   }
 
+  // Elastic problem - an elastic column relaxes each soft row, maximizing their sum minimizes the
+  // total violation. It is always feasable.
   int elasticCols = realRows_;
   glp_add_cols(tmp.lp_, elasticCols);
+  // glpk ignores the 0's index of the arrays
+  vector<int> indices(realCols + 2);
+  vector<double> values(realCols + 2);
   for (int i = 1; i <= elasticCols; ++i) {
-    int indices[MAX_VARS];
-    double values[MAX_VARS];
-    
     int row = i + structuralRows_;
-    int nonZeros = glp_get_mat_row(tmp.lp_, row, indices, values);
+    int nonZeros = glp_get_mat_row(tmp.lp_, row, &indices[0], &values[0]);
 
     indices[nonZeros + 1] = realCols + i;
     values[nonZeros + 1] = 1.0;
 
-    glp_set_mat_row(tmp.lp_, row, nonZeros + 1, indices, values);
+    glp_set_mat_row(tmp.lp_, row, nonZeros + 1, &indices[0], &values[0]);
     glp_set_obj_coef(tmp.lp_, realCols + i,  1);
     glp_set_col_bnds(tmp.lp_, realCols + i, GLP_UP, 0.0, 0.0);
   }
 
-  vector<int> suspects;
-  glp_std_basis(tmp.lp_);
+  vector<int> iis;
+  // The elastic columns are added non basic, so the current basis is still valid.
   int status = tmp.Solve();
-  while ((status != GLP_INFEAS) && (status != GLP_NOFEAS)) {
+  if (status != GLP_OPT) {
+    LOG_ERROR << "Elastic problem status " << status << ", can't find infeasable rows" << endl;
+    return iis;
+  }
+  if (glp_get_obj_val(tmp.lp_) > -EPSILON) {
+    // Nothing is violated, the problem is feasable.
+    return iis;
+  }
+
+  // The optimal row duals of the elastic problem are a Farkas certificate - the soft rows with a non
+  // zero dual, together with the hard rows, are infeasable. Only these are candidates.
+  vector<int> candidates;
+  for (int i = 1; i <= elasticCols; ++i) {
+    int row = i + structuralRows_;
+    if (fabs(glp_get_row_dual(tmp.lp_, row)) > EPSILON ||
+        glp_get_col_prim(tmp.lp_, realCols + i) < -EPSILON) {
+      candidates.push_back(row);
+    } else {
+      glp_set_row_bnds(tmp.lp_, row, GLP_FR, 0.0, 0.0);
+    }
+    glp_set_obj_coef(tmp.lp_, realCols + i, 0);
+    glp_set_col_bnds(tmp.lp_, realCols + i, GLP_FX, 0.0, 0.0);
+  }
+  Profiler::Count("IIS candidates", candidates.size());
+
+  int solves = 1;
+  status = tmp.SolveDual();
+  if (IsFeasable(status)) {
+    // Can only happen due to rounding - fall back to all the soft rows.
+    LOG_ERROR << "Farkas certificate is feasable, filtering all rows" << endl;
+    candidates.clear();
     for (int i = 1; i <= elasticCols; ++i) {
-      if (glp_get_col_prim(tmp.lp_, realCols + i) < 0) {
-        suspects.push_back(structuralRows_ + i);
-        glp_set_col_bnds(tmp.lp_, realCols + i, GLP_FX, 0.0, 0.0);
+      candidates.push_back(i + structuralRows_);
+    }
+  }
+
+  // QuickXplain over the candidates leaves an irreducible set. The hard rows alone are feasable
+  // (the elastic problem was), so the base needs no check. When looking for disjoint sets, the
+  // rows of the found set are freed and the search is run again over the rest of the candidates,
+  // as long as they are still infeasable. The elastic problem minimized the violation of all the
+  // conflicts at once, so the candidates cover the independent ones too.
+  vector<char> inIIS(glp_get_num_rows(tmp.lp_) + 1, 0);
+  int sets = 0;
+  while (!candidates.empty()) {
+    for (size_t i = 0; i < candidates.size(); ++i) {
+      glp_set_row_bnds(tmp.lp_, candidates[i], GLP_FR, 0.0, 0.0);
+    }
+    size_t first = iis.size();
+    QuickXplain(tmp, candidates, 0, candidates.size(), false, &iis, &solves);
+    ++sets;
+    if (!disjoint) {
+      break;
+    }
+
+    vector<int> remaining;
+    for (size_t i = first; i < iis.size(); ++i) {
+      inIIS[iis[i]] = 1;
+      glp_set_row_bnds(tmp.lp_, iis[i], GLP_FR, 0.0, 0.0);
+    }
+    for (size_t i = 0; i < candidates.size(); ++i) {
+      if (!inIIS[candidates[i]]) {
+        remaining.push_back(candidates[i]);
       }
     }
-    status = tmp.Solve();
+    CopyRowBounds(lp_, tmp.lp_, remaining, 0, remaining.size());
+    ++solves;
+    if (IsFeasable(tmp.SolveDual())) {
+      break;
+    }
+    candidates.swap(remaining);
   }
+  Profiler::Count("IIS solves", solves);
+  Profiler::Count("IIS sets", sets);
+  Profiler::Count("IIS rows", iis.size());
 
-  return suspects;
+  return iis;
 }
 
 void LinearProblem::RemoveRow(int row) {
-  static int indices[MAX_VARS];
-  static double values[MAX_VARS];
+  int cols = glp_get_num_cols(lp_);
+  // glpk ignores the 0's index of the arrays
+  vector<int> indices(cols + 1);
+  vector<double> values(cols + 1);
 
-  int nonZeros = glp_get_mat_row(lp_, row, indices, values);
+  int nonZeros = glp_get_mat_row(lp_, row, &indices[0], &values[0]);
   glp_set_row_bnds(lp_, row, GLP_FR, 0.0, 0.0);
 
-  // glpk ignores the 0's index of the array
-  int ind[2];
-  double val[2];
   for (int i = 1; i <= nonZeros; ++i) {
-    ind[1] = indices[i];
-    val[1] = (isMax(colToVar_[indices[i]]) ? -1 : 1);
-    int r = glp_add_rows(lp_, 1);
-    glp_set_row_bnds(lp_, r, GLP_UP, 0.0, MINUS_INFTY);
-    glp_set_mat_row(lp_, r, 1, ind, val);
-    glp_set_row_name(lp_, r, glp_get_row_name(lp_, row));    
+    SetUnbounded(indices[i], row);
+  }
+}
+
+void LinearProblem::SetUnbounded(int col, int reason, int cause) {
+  int rows = glp_get_num_rows(lp_), cols = glp_get_num_cols(lp_);
+  unboundedReason_.resize(cols + 1, 0);
+  unboundedCause_.resize(cols + 1, 0);
+  if (unboundedReason_[col] != 0) {
+    return;
+  }
+  unboundedReason_[col] = reason;
+  unboundedCause_[col] = cause;
+
+  // glpk ignores the 0's index of the arrays
+  vector<int> rowIndices(rows + 1), colIndices(cols + 1);
+  vector<double> rowValues(rows + 1), colValues(cols + 1);
+  // Columns to propagate, already flagged.
+  vector<int> pending(1, col);
+  int flagged = 0;
+  while (!pending.empty()) {
+    int c = pending.back();
+    pending.pop_back();
+    glp_set_col_bnds(lp_, c, GLP_FX, 0.0, 0.0);
+    ++flagged;
+
+    // Max variables are minimized and min variables maximized, negating the min variables makes
+    // all of them minimized, and the infinite value +infinity.
+    double sign = VarTable::IsMax(colToVar_[c]) ? 1.0 : -1.0;
+    int nonZeros = glp_get_mat_col(lp_, c, &rowIndices[0], &rowValues[0]);
+    for (int k = 1; k <= nonZeros; ++k) {
+      int row = rowIndices[k];
+      if (glp_get_row_type(lp_, row) == GLP_FR) {
+        continue;
+      }
+      glp_set_row_bnds(lp_, row, GLP_FR, 0.0, 0.0);
+      if (rowValues[k] * sign < 0) {
+        // -infinity <= C always holds.
+        continue;
+      }
+
+      int size = glp_get_mat_row(lp_, row, &colIndices[0], &colValues[0]);
+      bool holds = false;
+      for (int i = 1; i <= size && !holds; ++i) {
+        // A column waiting in pending may already make the row hold.
+        int other = colIndices[i];
+        double otherSign = VarTable::IsMax(colToVar_[other]) ? 1.0 : -1.0;
+        holds = (unboundedReason_[other] != 0) && (colValues[i] * otherSign < 0);
+      }
+      bool found = holds;
+      for (int pass = 0; pass < 2 && !found; ++pass) {
+        // First pass - the variables which can be -infinity, second pass - all of them.
+        for (int i = 1; i <= size; ++i) {
+          int other = colIndices[i];
+          double otherSign = VarTable::IsMax(colToVar_[other]) ? 1.0 : -1.0;
+          if (unboundedReason_[other] != 0 || (pass == 0 && colValues[i] * otherSign >= 0)) {
+            continue;
+          }
+          unboundedReason_[other] = row;
+          unboundedCause_[other] = c;
+          pending.push_back(other);
+          found = true;
+        }
+      }
+    }
   }
+  Profiler::Count("unbounded columns", flagged);
+}
+
+double LinearProblem::Value(int col) const {
+  if (IsUnbounded(col)) {
+    double infinity = std::numeric_limits<double>::infinity();
+    return VarTable::IsMax(colToVar_[col]) ? infinity : -infinity;
+  }
+  return glp_get_col_prim(lp_, col);
+}
+
+void LinearProblem::UnboundedReasons(int col, vector<int>* rows, vector<int>* sources) const {
+  while (IsUnbounded(col)) {
+    int reason = unboundedReason_[col];
+    if (reason < 0) {
+      sources->push_back(-reason - 1);
+      return;
+    }
+    rows->push_back(reason);
+    col = unboundedCause_[col];
+  }
+}
+
+LinearProblem::LinearProblem(const LinearProblemSnapshot &snapshot) {
+  lp_ = glp_create_prob();
+  glp_set_obj_dir(lp_, snapshot.objDir_);
+  int rows = snapshot.rows_.size() - 1, cols = snapshot.cols_.size() - 1;
+  if (rows > 0) {
+    glp_add_rows(lp_, rows);
+  }
+  if (cols > 0) {
+    glp_add_cols(lp_, cols);
+  }
+  for (int i = 1; i <= rows; ++i) {
+    const LinearProblemSnapshot::Bounds &row = snapshot.rows_[i];
+    glp_set_row_bnds(lp_, i, row.type_, row.lb_, row.ub_);
+    glp_set_row_stat(lp_, i, row.stat_);
+  }
+  for (int j = 1; j <= cols; ++j) {
+    const LinearProblemSnapshot::Bounds &col = snapshot.cols_[j];
+    glp_set_col_bnds(lp_, j, col.type_, col.lb_, col.ub_);
+    glp_set_col_stat(lp_, j, col.stat_);
+    glp_set_obj_coef(lp_, j, snapshot.obj_[j]);
+  }
+  glp_load_matrix(lp_, snapshot.ia_.size() - 1, &snapshot.ia_[0], &snapshot.ja_[0],
+                  &snapshot.ar_[0]);
+
+  params_ = snapshot.params_;
+  realRows_ = snapshot.realRows_;
+  structuralRows_ = snapshot.structuralRows_;
+  aliasingRows_ = snapshot.aliasingRows_;
+  varToCol_ = snapshot.varToCol_;
+  colToVar_ = snapshot.colToVar_;
+  rowOrigin_ = snapshot.rowOrigin_;
+  unboundedReason_ = snapshot.unboundedReason_;
+  unboundedCause_ = snapshot.unboundedCause_;
+}
+
+void LinearProblem::Save(LinearProblemSnapshot *snapshot) const {
+  int rows = glp_get_num_rows(lp_), cols = glp_get_num_cols(lp_);
+  snapshot->objDir_ = glp_get_obj_dir(lp_);
+  snapshot->rows_.resize(rows + 1);
+  snapshot->cols_.resize(cols + 1);
+  snapshot->obj_.resize(cols + 1);
+  snapshot->ia_.assign(1, 0);
+  snapshot->ja_.assign(1, 0);
+  snapshot->ar_.assign(1, 0.0);
+
+  // glpk ignores the 0's index of the arrays
+  vector<int> ind(cols + 1);
+  vector<double> val(cols + 1);
+  for (int i = 1; i <= rows; ++i) {
+    LinearProblemSnapshot::Bounds &row = snapshot->rows_[i];
+    row.type_ = glp_get_row_type(lp_, i);
+    row.lb_ = glp_get_row_lb(lp_, i);
+    row.ub_ = glp_get_row_ub(lp_, i);
+    row.stat_ = glp_get_row_stat(lp_, i);
+    int nonZeros = glp_get_mat_row(lp_, i, &ind[0], &val[0]);
+    for (int k = 1; k <= nonZeros; ++k) {
+      snapshot->ia_.push_back(i);
+      snapshot->ja_.push_back(ind[k]);
+      snapshot->ar_.push_back(val[k]);
+    }
+  }
+  for (int j = 1; j <= cols; ++j) {
+    LinearProblemSnapshot::Bounds &col = snapshot->cols_[j];
+    col.type_ = glp_get_col_type(lp_, j);
+    col.lb_ = glp_get_col_lb(lp_, j);
+    col.ub_ = glp_get_col_ub(lp_, j);
+    col.stat_ = glp_get_col_stat(lp_, j);
+    snapshot->obj_[j] = glp_get_obj_coef(lp_, j);
+  }
+
+  snapshot->params_ = params_;
+  snapshot->realRows_ = realRows_;
+  snapshot->structuralRows_ = structuralRows_;
+  snapshot->aliasingRows_ = aliasingRows_;
+  snapshot->varToCol_ = varToCol_;
+  snapshot->colToVar_ = colToVar_;
+  snapshot->rowOrigin_ = rowOrigin_;
+  snapshot->unboundedReason_ = unboundedReason_;
+  snapshot->unboundedCause_ = unboundedCause_;
 }
 
 LinearProblem& LinearProblem::operator=(const LinearProblem &old) {
@@ -78,23 +366,121 @@ LinearProblem& LinearProblem::operator=(const LinearProblem &old) {
   return *this;
 }
 
-void LinearProblem::RemoveInfeasable() {
-  LOG << "No Feasable solution, running elastic filter - " << endl;
+int LinearProblem::RemoveInfeasable() {
+  ProfileScope scope("RemoveInfeasable");
+  LOG_INFO << "No Feasable solution, looking for an irreducible infeasable set - " << endl;
 
-  vector<int> rows = ElasticFilter();
+  vector<int> rows = FindIIS(batchRepair_);
   sort(rows.begin(), rows.end());
 
-  // glpk ignores the 0's index of the array
-  int ind[2], removed = rows.size();
-  realRows_ -= removed;
-  LOG << "removing " << removed << " rows" << endl;  
+  int removed = rows.size();
+  LOG_INFO << "removing " << removed << " rows" << endl;  
+  Profiler::Count("removed rows", removed);
+  // The removed rows are only freed, not deleted - deleting a non basic row would invalidate the
+  // basis, and the next solve could not start from it.
   for (int i = 0; i < removed; ++i) {
-    int cur = rows[i] - i;
-    RemoveRow(cur);
-    ind[1] = cur;
-    glp_del_rows(lp_, 1, ind);
+    RemoveRow(rows[i]);
+  }
+  return removed;
+}
+
+bool LinearProblem::BoundedColumns(vector<bool>* bounded) const {
+  ProfileScope scope("BoundedColumns");
+  int rows = glp_get_num_rows(lp_), cols = glp_get_num_cols(lp_);
+  bounded->assign(cols + 1, false);
+  if (cols + 1 > static_cast<int>(colToVar_.size())) {
+    return false;
+  }
+
+  // Max variables are minimized and min variables maximized, negating the min variables makes all
+  // of them minimized (see ConstraintProblem::SolveDifferences).
+  vector<double> sign(cols + 1);
+  for (int j = 1; j <= cols; ++j) {
+    sign[j] = VarTable::IsMax(colToVar_[j]) ? 1.0 : -1.0;
+  }
+
+  DifferenceSolver solver(cols + 1);
+  bool exact = true;
+  uint32_t var;
+  double coef;
+  for (int j = 1; j <= cols; ++j) {
+    int type = glp_get_col_type(lp_, j);
+    var = j;
+    if (type == GLP_UP || type == GLP_DB || type == GLP_FX) {
+      coef = sign[j];
+      solver.AddRow(1, &var, &coef, glp_get_col_ub(lp_, j));
+    }
+    if (type == GLP_LO || type == GLP_DB || type == GLP_FX) {
+      coef = -sign[j];
+      solver.AddRow(1, &var, &coef, -glp_get_col_lb(lp_, j));
+    }
+  }
+
+  // glpk ignores the 0's index of the arrays
+  vector<int> ind(cols + 1);
+  vector<double> val(cols + 1);
+  vector<uint32_t> vars(cols);
+  vector<double> coefs(cols);
+  for (int i = 1; i <= rows; ++i) {
+    int type = glp_get_row_type(lp_, i);
+    if (type == GLP_FR) {
+      continue;
+    }
+    int nonZeros = glp_get_mat_row(lp_, i, &ind[0], &val[0]);
+    for (int k = 1; k <= nonZeros; ++k) {
+      vars[k - 1] = ind[k];
+      coefs[k - 1] = val[k] * sign[ind[k]];
+    }
+    if (type == GLP_UP || type == GLP_DB || type == GLP_FX) {
+      exact = solver.AddRow(nonZeros, &vars[0], &coefs[0], glp_get_row_ub(lp_, i)) && exact;
+    }
+    if (type == GLP_LO || type == GLP_DB || type == GLP_FX) {
+      for (int k = 0; k < nonZeros; ++k) {
+        coefs[k] = -coefs[k];
+      }
+      exact = solver.AddRow(nonZeros, &vars[0], &coefs[0], -glp_get_row_lb(lp_, i)) && exact;
+    }
+  }
+
+  if (!solver.Solve()) {
+    // Infeasable, nothing is known.
+    return false;
+  }
+  for (int j = 1; j <= cols; ++j) {
+    (*bounded)[j] = (solver.Value(j) != DifferenceSolver::MinusInfinity());
+  }
+  return exact;
+}
+
+int LinearProblem::Solve(int method) {
+  ProfileScope scope("simplex");
+  glp_term_hook(&printToLog, NULL);
+  if (coldStart_) {
+    glp_std_basis(lp_);
+    method = GLP_PRIMAL;
+  }
+  params_.meth = method;
+  int before = glp_get_it_cnt(lp_);
+  int result = glp_simplex(lp_, &params_);
+  Profiler::Count((method == GLP_PRIMAL) ? "primal iterations" : "dual iterations",
+                  glp_get_it_cnt(lp_) - before);
+  if ((result != 0) && !coldStart_) {
+    // The warm start failed - a singular or ill conditioned basis, or an iteration limit. Retry
+    // once from the standard basis.
+    LOG_INFO << "glp_simplex failed (" << result << "), restarting from the standard basis" << endl;
+    Profiler::Count("simplex restarts", 1);
+    glp_std_basis(lp_);
+    params_.meth = GLP_PRIMAL;
+    before = glp_get_it_cnt(lp_);
+    result = glp_simplex(lp_, &params_);
+    Profiler::Count("primal iterations", glp_get_it_cnt(lp_) - before);
+  }
+  if (result != 0) {
+    // The status is of the last basis glpk reached, which is not a solution.
+    LOG_ERROR << "glp_simplex failed (" << result << ")" << endl;
+    return GLP_UNDEF;
   }
-  glp_std_basis(lp_);
+  return glp_get_status(lp_);
 }
 
 } // namespace boa
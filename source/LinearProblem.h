@@ -10,25 +10,68 @@ using std::vector;
 using std::map;
 
 #include "log.h"
-
-#define MINUS_INFTY (std::numeric_limits<int>::min())
+#include "Profiler.h"
+#include "VarTable.h"
 
 namespace boa {
 
+/**
+  A plain copy of a LinearProblem and its basis, which does not refer to any glpk memory.
+
+  Each thread has its own glpk environment, and a glp_prob may only be used by the thread which
+  created it. A snapshot is used to hand a problem over to another thread.
+*/
+struct LinearProblemSnapshot {
+  struct Bounds {
+    int type_;
+    double lb_, ub_;
+    int stat_;
+  };
+
+  int objDir_;
+  // Indexed by row / column number, the 0'th entry is unused.
+  vector<Bounds> rows_, cols_;
+  vector<double> obj_;
+  // The matrix in glpk triplet form, the 0'th entry is unused.
+  vector<int> ia_, ja_;
+  vector<double> ar_;
+
+  glp_smcp params_;
+  int realRows_, structuralRows_, aliasingRows_;
+  vector<int> varToCol_;
+  vector<VarId> colToVar_;
+  vector<int> rowOrigin_;
+  vector<int> unboundedReason_, unboundedCause_;
+};
+
 class LinearProblem {
   // because of llvm command structure, each constraint affect 3(?) variables at the most
   static const int MAX_VARS = 10;
+  static const double EPSILON;
 
   glp_smcp params_;
+  static bool coldStart_;
+  static bool batchRepair_;
 
-  static bool isMax(string s) {
-    return (s.substr(s.length() - 3) == "max");
-  }
+  int Solve(int method);
 
   static bool IsFeasable(int status) {
     return ((status != GLP_INFEAS) && (status != GLP_NOFEAS));
   }
 
+  /**
+    QuickXplain (Junker, 2004) - add to iis a minimal subset of the rows candidates[begin, end)
+    which is infeasable together with the rows enabled in tmp, a copy of this problem. Candidates
+    are disabled (free) in tmp on entry, the rows added to iis are enabled on exit.
+
+    Splitting the candidates in halves drops a whole half with a single dual simplex when it is not
+    needed, so a set of k rows out of n candidates takes O(k log(n / k)) solves instead of the n of
+    a deletion filter. checkBase is set when rows were enabled since the enabled rows were last
+    known to be feasable. solves counts the dual simplex calls.
+  */
+  void QuickXplain(LinearProblem& tmp, const vector<int>& candidates, size_t begin, size_t end,
+                   bool checkBase, vector<int>* iis /* out */, int* solves /* out */) const;
+
   void copyFrom(const LinearProblem &old) {
     this->lp_ = glp_create_prob();
     glp_copy_prob(this->lp_, old.lp_, GLP_ON);
@@ -37,13 +80,23 @@ class LinearProblem {
     this->colToVar_ = old.colToVar_;
     this->structuralRows_ = old.structuralRows_;
     this->aliasingRows_ = old.aliasingRows_;
+    this->rowOrigin_ = old.rowOrigin_;
+    this->unboundedReason_ = old.unboundedReason_;
+    this->unboundedCause_ = old.unboundedCause_;
   }
 
  public:
   glp_prob *lp_;
   int realRows_, structuralRows_, aliasingRows_;
-  map<string, int> varToCol_;
-  map<int, string> colToVar_;
+  // Indexed by VarId::Index(), 0 for variables which are not part of the problem.
+  vector<int> varToCol_;
+  // Indexed by column number, the 0'th entry is unused.
+  vector<VarId> colToVar_;
+  // The ConstraintStore row each lp row was created from, indexed by row number (the 0'th entry is
+  // unused). Used to find the blame of a row.
+  vector<int> rowOrigin_;
+  // Indexed by column number, see SetUnbounded. The reason is 0 for a bounded column.
+  vector<int> unboundedReason_, unboundedCause_;
 
 
   LinearProblem() {
@@ -54,6 +107,16 @@ class LinearProblem {
     copyFrom(old);
   }
 
+  /**
+    Create a problem in the calling thread's glpk environment from a snapshot, including the basis.
+  */
+  explicit LinearProblem(const LinearProblemSnapshot &snapshot);
+
+  /**
+    Copy the problem and its current basis to snapshot.
+  */
+  void Save(LinearProblemSnapshot *snapshot /* out */) const;
+
   LinearProblem& operator=(const LinearProblem &old);
 
   ~LinearProblem() {
@@ -61,9 +124,26 @@ class LinearProblem {
   }
 
   /**
-    Efficiently identify a small group of infeasble constraints using elastic fileter algorithm
+    The column of a variable, or 0 if the variable is not part of the problem.
   */
-  vector<int> ElasticFilter() const;
+  int Col(VarId var) const {
+    return (var.Index() < varToCol_.size()) ? varToCol_[var.Index()] : 0;
+  }
+
+  /**
+    Find an irreducible infeasable set (IIS) of the soft rows - structuralRows_ + 1 to
+    structuralRows_ + realRows_, all the other rows are hard. The problem must be infeasable.
+
+    The candidates are the support of a Farkas certificate, read from the row duals of a single
+    elastic solve, and QuickXplain over the candidates leaves an irreducible set - a half of the
+    candidates which is not needed is dropped with a single test. Each test is a warm started dual
+    simplex, counted by the "IIS solves" profile counter.
+
+    If disjoint is set, keep filtering the rest of the candidates after a set is found, and return
+    the rows of all the disjoint sets found. Otherwise return the rows of a single set. The result
+    is empty if the problem is feasable.
+  */
+  vector<int> FindIIS(bool disjoint = false) const;
 
   void SetParams(const glp_smcp& params) {
     params_ = params;
@@ -71,20 +151,93 @@ class LinearProblem {
 
 
   /**
-    Solve the linear problem and return the glpk status
+    Solve the linear problem with the primal simplex and return the glpk status.
+
+    If glp_simplex fails from the current basis it is retried once from the standard basis, and if
+    that fails too the status is GLP_UNDEF.
+
+    Starts from the current basis, which is kept valid by all the modifications done by boa. Use
+    after objective changes, which keep the basis primal feasable.
   */
   int Solve() {
-    glp_simplex(lp_, &params_);
-    return glp_get_status(lp_);
+    return Solve(GLP_PRIMAL);
   }
 
   /**
-    Remove a row from a linear problem matrix, create "unbound constraints" instead
+    Solve the linear problem with the dual simplex and return the glpk status.
 
-    The new constraints created at the end of the matrix.
+    Use after bound changes and added rows, which keep an optimal basis dual feasable. glpk falls
+    back to the primal simplex if the basis is not dual feasable.
+  */
+  int SolveDual() {
+    return Solve(GLP_DUALP);
+  }
+
+  /**
+    Disable warm starts - every solve starts from the standard basis with the primal simplex.
+    Used to measure the iterations saved by warm starts.
+  */
+  static void SetColdStart(bool cold) {
+    coldStart_ = cold;
+  }
+
+  /**
+    Make RemoveInfeasable remove all the disjoint infeasable sets it finds at once (the default),
+    or a single set each call.
+  */
+  static void SetBatchRepair(bool batch) {
+    batchRepair_ = batch;
+  }
+
+  /**
+    Remove a row from a linear problem matrix, and make each of its variables unbounded.
+
+    The row is left in the matrix as a free row, so the matrix keeps its size and a valid basis
+    stays valid.
   */
   void RemoveRow(int row);
 
+  /**
+    Make a column unbounded - +infinity for a max variable and -infinity for a min variable.
+
+    There are no infinite values in the matrix. The column is fixed at 0 and flagged, and the
+    infinity is propagated through the rows: a row in which the column's term is -infinity always
+    holds, and is freed. A row in which it is +infinity can only hold if other terms are -infinity
+    too, so the variables which can make it hold become unbounded as well (all the other
+    variables, as in RemoveRow, if there are none), and the row is freed. Every row of an unbounded
+    column is free, and the number of rows and columns never changes.
+
+    reason is the row which made the column unbounded, or -(i + 1) for the i'th unbounded source
+    of the ConstraintStore. cause is the column whose infinity propagated through the reason row,
+    or 0.
+  */
+  void SetUnbounded(int col, int reason, int cause = 0);
+
+  bool IsUnbounded(int col) const {
+    return (col < static_cast<int>(unboundedReason_.size())) && (unboundedReason_[col] != 0);
+  }
+
+  /**
+    The value of a column in the current solution, +-infinity for an unbounded column.
+  */
+  double Value(int col) const;
+
+  /**
+    Why is the column unbounded? Add the rows the infinity propagated through to rows, and the
+    unbounded source it came from (if any) to sources.
+  */
+  void UnboundedReasons(int col, vector<int>* rows /* out */, vector<int>* sources /* out */) const;
+
+  /**
+    Find the columns whose objective direction is bounded - max variables which can not decrease
+    and min variables which can not increase indefinitely, using only the rows which are
+    difference constraints (see DifferenceSolver).
+
+    A column marked bounded is bounded in the linear problem. Return true if every row is a
+    difference constraint, in which case the other columns are known to be unbounded.
+  */
+  bool BoundedColumns(vector<bool>* bounded /* out */) const;
+
   int NumCols() const {
     return glp_get_num_cols(lp_);
   }
@@ -92,14 +245,19 @@ class LinearProblem {
   /**
     Remove a minimal set of constraints that makes the lp inFeasable.
 
-    Each of the variables in the removed rows will become "unbound" (e.g. - ...!max >= MAX_INT  or
-    ...!min <= MIN_INT).
+    Each of the variables in the removed rows will become unbounded (see SetUnbounded).
 
     The removed set is *A* minimal in the sense that these lines alone form an inFeasable problem, and
     each subset of them does not. It is not nessecerily *THE* minimal set in the sense that there is
     no such set which is smaller in size.
+
+    Unless SetBatchRepair(false) was called, all the disjoint minimal sets found by one FindIIS call
+    are removed together, so the number of repair rounds depends on the depth of the conflicts and
+    not on their count.
+
+    Continue with SolveDual(), the current basis is kept. Return the number of removed rows.
   */
-  void RemoveInfeasable();
+  int RemoveInfeasable();
 };
 
 } // namespace boa
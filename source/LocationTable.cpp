@@ -0,0 +1,63 @@
+#include "LocationTable.h"
+
+#include <sstream>
+
+using std::stringstream;
+
+namespace boa {
+
+const unsigned LocationTable::NO_LINE;
+
+StringPool LocationTable::files_;
+vector<pair<uint32_t, unsigned> > LocationTable::locations_(1, std::make_pair(0u, NO_LINE));
+map<pair<uint32_t, unsigned>, uint32_t> LocationTable::ids_;
+map<const void*, Location> LocationTable::nodes_;
+
+Location LocationTable::Intern(uint32_t file, unsigned line) {
+  pair<uint32_t, unsigned> key(file, line);
+  if (key == locations_[0]) {
+    return Location();
+  }
+  map<pair<uint32_t, unsigned>, uint32_t>::iterator it = ids_.lower_bound(key);
+  if (it != ids_.end() && it->first == key) {
+    return Location(it->second);
+  }
+  uint32_t id = locations_.size();
+  ids_.insert(it, std::make_pair(key, id));
+  locations_.push_back(key);
+  return Location(id);
+}
+
+bool LocationTable::Lookup(const void* node, Location* location) {
+  map<const void*, Location>::const_iterator it = nodes_.find(node);
+  if (it == nodes_.end()) {
+    return false;
+  }
+  *location = it->second;
+  return true;
+}
+
+void LocationTable::GetParts(Location location, string* file, unsigned* line) {
+  const pair<uint32_t, unsigned>& loc = locations_[location.Index()];
+  *file = files_.Get(loc.first);
+  *line = loc.second;
+}
+
+string LocationTable::ToString(Location location) {
+  const pair<uint32_t, unsigned>& loc = locations_[location.Index()];
+  if (loc.second == NO_LINE) {
+    return files_.Get(loc.first);
+  }
+  stringstream ss;
+  ss << files_.Get(loc.first) << ":" << loc.second;
+  return ss.str();
+}
+
+void LocationTable::Clear() {
+  files_.Clear();
+  locations_.resize(1);
+  ids_.clear();
+  nodes_.clear();
+}
+
+}  // namespace boa
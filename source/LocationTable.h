@@ -0,0 +1,114 @@
+#ifndef __BOA_LOCATIONTABLE_H
+#define __BOA_LOCATIONTABLE_H /* */
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "StringPool.h"
+
+using std::map;
+using std::pair;
+using std::string;
+using std::vector;
+
+namespace boa {
+
+/**
+  A cheap handle to a source location, see LocationTable. The default location is empty.
+*/
+class Location {
+  uint32_t id_;
+
+  explicit Location(uint32_t id) : id_(id) {}
+  friend class LocationTable;
+
+ public:
+  Location() : id_(0) {}
+
+  uint32_t Index() const {
+    return id_;
+  }
+
+  bool operator==(const Location& other) const {
+    return id_ == other.id_;
+  }
+};
+
+/**
+  Table of the source locations constraints originate from.
+
+  A location is either a (file, line) pair, with the file name interned, or a free text describing a
+  location which has no line (e.g. "(literal)"). Locations are also cached by the debug location
+  node they were extracted from, so the debug metadata of a node needs to be walked only once.
+*/
+class LocationTable {
+  static const unsigned NO_LINE = ~0u;
+
+  static StringPool files_;
+  // (file id, line) of each location, the line is NO_LINE for free text locations.
+  static vector<pair<uint32_t, unsigned> > locations_;
+  static map<pair<uint32_t, unsigned>, uint32_t> ids_;
+  static map<const void*, Location> nodes_;
+
+  static Location Intern(uint32_t file, unsigned line);
+
+ public:
+  /**
+    The location of line "line" in file "file"
+  */
+  static Location FromFileLine(const string& file, unsigned line) {
+    return Intern(files_.Intern(file), line);
+  }
+
+  /**
+    A location described by a free text
+  */
+  static Location FromText(const string& text) {
+    return Intern(files_.Intern(text), NO_LINE);
+  }
+
+  /**
+    The file (or free text) and the line of location, the line is ~0u for a free text location.
+    FromFileLine(file, line) returns the same location.
+  */
+  static void GetParts(Location location, string* file /* out */, unsigned* line /* out */);
+
+  /**
+    Find the location previously cached for debug location node "node". Return false if there is
+    no such location.
+  */
+  static bool Lookup(const void* node, Location* location /* out */);
+
+  /**
+    Cache "location" as the location of debug location node "node".
+  */
+  static void Cache(const void* node, Location location) {
+    nodes_[node] = location;
+  }
+
+  /**
+    Render the location, in the form "file:line"
+  */
+  static string ToString(Location location);
+
+  /**
+    Forget the debug location nodes cached by Cache, once the module they belong to is gone. The
+    locations themselves are kept.
+  */
+  static void ClearNodes() {
+    nodes_.clear();
+  }
+
+  /**
+    Forget all locations. Locations created before calling Clear must not be used afterwards.
+  */
+  static void Clear();
+};
+
+}  // namespace boa
+
+#endif  // __BOA_LOCATIONTABLE_H
@@ -0,0 +1,293 @@
+#include "ModelTable.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <utility>
+
+#include "Helpers.h"
+#include "log.h"
+
+using std::endl;
+using std::ifstream;
+using std::istreambuf_iterator;
+using std::pair;
+using std::sort;
+using std::stringstream;
+
+namespace boa {
+
+// The content of models/libc.models as a string literal, generated by the Makefile.
+static const char LIBC_MODELS[] =
+#include "libc.models.inc"
+    ;
+
+namespace {
+
+struct KindInfo {
+  const char* name_;
+  ModelTable::Kind kind_;
+  unsigned args_;
+  // The blames of the model's constraints, "%s" is replaced by the function. Blames of buffer
+  // aliases are complete (see ConstraintGenerator::GenerateBufferAliasConstraint).
+  const char* blames_[ModelTable::MAX_BLAMES];
+};
+
+const KindInfo KINDS[] = {
+  { "safe",           ModelTable::SAFE,           0, { NULL } },
+  { "unsafe",         ModelTable::UNSAFE,         0, { NULL } },
+  { "alloc",          ModelTable::ALLOC,          1, { "%s call" } },
+  { "duplicate",      ModelTable::DUPLICATE,      1, { "%s call" } },
+  { "length",         ModelTable::LENGTH,         1, { "%s call" } },
+  { "string_copy",    ModelTable::STRING_COPY,    2, { "%s call" } },
+  { "format",         ModelTable::FORMAT,         2, { "%s call",
+                                                       "%s with unknown length format string" } },
+  { "bounded_write",  ModelTable::BOUNDED_WRITE,  2, { "%s call" } },
+  { "fixed_write",    ModelTable::FIXED_WRITE,    2, { "%s call" } },
+  { "find",           ModelTable::FIND,           1, { "%s call" } },
+  { "static_string",  ModelTable::STATIC_STRING,  0, { "%s call" } },
+  { "search",         ModelTable::SEARCH,         2, {
+      "%s call might read beyond the buffer",
+      "buffer alias with offset - use of %s return value" } },
+  { "compare",        ModelTable::COMPARE,        3, { "%s might read beyond array boundaries",
+                                                       "use of %s return value" } },
+  { "move",           ModelTable::MOVE,           3, {
+      "%s source buffer",
+      "%s destination buffer",
+      "buffer alias - use of %s return value" } },
+  { "fill",           ModelTable::FILL,           2, { "%s might write beyond array boundaries" } },
+  { "copy",           ModelTable::COPY,           3, { "%s write to destination buffer",
+                                                       "%s read from source buffer" } }
+};
+
+const KindInfo* FindKind(const string& name) {
+  for (size_t i = 0; i < sizeof(KINDS) / sizeof(KINDS[0]); ++i) {
+    if (name == KINDS[i].name_) {
+      return &KINDS[i];
+    }
+  }
+  return NULL;
+}
+
+const string PATTERN(".*");
+const string INTRINSIC("llvm.");
+
+// Gives up on a table size when a bucket finds no seed, and tries a larger one.
+const uint32_t MAX_SEED = 1 << 16;
+
+uint64_t SlotHash(const char* key, size_t size, uint32_t seed) {
+  return Helpers::HashBytes(key, size, Helpers::HASH_SEED ^ (seed * 0x9e3779b97f4a7c15ULL));
+}
+
+bool IsSuffix(const string& suffix, const string& str) {
+  return str.size() >= suffix.size() &&
+         str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+}  // namespace
+
+bool ModelTable::Model::Fits(unsigned arguments) const {
+  for (unsigned i = 0; i < argCount_; ++i) {
+    // The last index written is a number, not an argument.
+    if (kind_ == FIXED_WRITE && i == 1) {
+      continue;
+    }
+    if (args_[i] >= arguments) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Static.
+const ModelTable& ModelTable::Libc() {
+  static ModelTable* libc = NULL;
+  if (libc == NULL) {
+    libc = new ModelTable();
+    string error;
+    if (!libc->Add(LIBC_MODELS, "models/libc.models", &error)) {
+      LOG_ERROR << error << endl;
+    }
+  }
+  return *libc;
+}
+
+bool ModelTable::Add(const string& spec, const string& origin, string* error) {
+  map<string, Model> added;
+  stringstream lines(spec);
+  string line;
+  for (unsigned number = 1; getline(lines, line); ++number) {
+    line = line.substr(0, line.find('#'));
+    stringstream words(line);
+    string function, kindName;
+    if (!(words >> function)) {
+      continue;
+    }
+    stringstream where;
+    where << origin << ":" << number << ": ";
+    const KindInfo* kind = (words >> kindName) ? FindKind(kindName) : NULL;
+    if (kind == NULL) {
+      *error = where.str() + "unknown model \"" + kindName + "\" of " + function;
+      return false;
+    }
+    Model model;
+    model.kind_ = kind->kind_;
+    model.argCount_ = 0;
+    memset(model.args_, 0, sizeof(model.args_));
+    string arg;
+    while (words >> arg) {
+      char* end;
+      unsigned long value = strtoul(arg.c_str(), &end, 10);
+      if (!isdigit(arg[0]) || *end != '\0' || model.argCount_ == MAX_ARGS) {
+        *error = where.str() + "bad argument \"" + arg + "\" of " + function;
+        return false;
+      }
+      model.args_[model.argCount_++] = value;
+    }
+    if (model.argCount_ != kind->args_) {
+      stringstream message;
+      message << where.str() << kindName << " takes " << kind->args_ << " arguments";
+      *error = message.str();
+      return false;
+    }
+
+    string key = function;
+    model.function_ = function;
+    if (IsSuffix(PATTERN, function)) {
+      // Keyed with the '.', see Find.
+      key.erase(key.size() - 1);
+      model.function_.erase(model.function_.size() - PATTERN.size());
+    }
+    if (Helpers::IsPrefix(INTRINSIC, model.function_)) {
+      model.function_.erase(0, INTRINSIC.size());
+    }
+    for (unsigned i = 0; i < MAX_BLAMES && kind->blames_[i] != NULL; ++i) {
+      string blame = kind->blames_[i];
+      blame.replace(blame.find("%s"), 2, model.function_);
+      model.blames_[i] = BlameMessage(blame);
+    }
+    added[key] = model;
+  }
+
+  for (map<string, Model>::iterator it = added.begin(); it != added.end(); ++it) {
+    models_[it->first] = it->second;
+  }
+  Compile();
+  return true;
+}
+
+bool ModelTable::Load(const string& path, string* error) {
+  ifstream in(path.c_str());
+  if (!in) {
+    *error = "can't read " + path;
+    return false;
+  }
+  string spec((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+  return Add(spec, path, error);
+}
+
+void ModelTable::Compile() {
+  keys_.clear();
+  values_.clear();
+  for (map<string, Model>::iterator it = models_.begin(); it != models_.end(); ++it) {
+    keys_.push_back(it->first);
+    values_.push_back(it->second);
+  }
+
+  vector<vector<int> > buckets(keys_.size() / 2 + 1);
+  for (size_t i = 0; i < keys_.size(); ++i) {
+    buckets[Helpers::Hash(keys_[i]) % buckets.size()].push_back(i);
+  }
+  size_t size = 1;
+  while (size < keys_.size()) {
+    size *= 2;
+  }
+  while (!Place(buckets, size)) {
+    size *= 2;
+  }
+  LOG_DEBUG << "Compiled " << keys_.size() << " models into " << size << " slots" << endl;
+}
+
+bool ModelTable::Place(const vector<vector<int> >& buckets, size_t size) {
+  // Hash and displace - the buckets are placed largest first, each with the first seed which
+  // hashes all of its keys to free slots.
+  vector<pair<size_t, size_t> > order;
+  for (size_t b = 0; b < buckets.size(); ++b) {
+    order.push_back(std::make_pair(buckets[b].size(), b));
+  }
+  sort(order.rbegin(), order.rend());
+
+  seeds_.assign(buckets.size(), 0);
+  slots_.assign(size, -1);
+  for (size_t o = 0; o < order.size() && order[o].first > 0; ++o) {
+    const vector<int>& keys = buckets[order[o].second];
+    uint32_t seed = 1;
+    vector<size_t> taken;
+    while (taken.size() < keys.size()) {
+      if (seed == MAX_SEED) {
+        return false;
+      }
+      taken.clear();
+      for (size_t k = 0; k < keys.size(); ++k) {
+        const string& key = keys_[keys[k]];
+        size_t slot = SlotHash(key.data(), key.size(), seed) & (size - 1);
+        if (slots_[slot] != -1 || std::find(taken.begin(), taken.end(), slot) != taken.end()) {
+          break;
+        }
+        taken.push_back(slot);
+      }
+      ++seed;
+    }
+    for (size_t k = 0; k < keys.size(); ++k) {
+      slots_[taken[k]] = keys[k];
+    }
+    seeds_[order[o].second] = seed - 1;
+  }
+  return true;
+}
+
+const ModelTable::Model* ModelTable::FindKey(const char* key, size_t size) const {
+  if (slots_.empty()) {
+    return NULL;
+  }
+  uint32_t seed = seeds_[Helpers::HashBytes(key, size) % seeds_.size()];
+  int slot = slots_[SlotHash(key, size, seed) & (slots_.size() - 1)];
+  if (slot == -1 || keys_[slot].size() != size || memcmp(keys_[slot].data(), key, size) != 0) {
+    return NULL;
+  }
+  return &values_[slot];
+}
+
+const ModelTable::Model* ModelTable::Find(const char* name, size_t size) const {
+  if (const Model* model = FindKey(name, size)) {
+    return model;
+  }
+  // ".*" patterns are keyed by their prefix up to and including the '.', the longest one wins.
+  for (size_t i = size; i > 0; --i) {
+    if (name[i - 1] == '.') {
+      if (const Model* model = FindKey(name, i)) {
+        return model;
+      }
+    }
+  }
+  return NULL;
+}
+
+uint64_t ModelTable::Fingerprint() const {
+  stringstream all;
+  for (map<string, Model>::const_iterator it = models_.begin(); it != models_.end(); ++it) {
+    all << it->first << " " << it->second.kind_;
+    for (unsigned i = 0; i < it->second.argCount_; ++i) {
+      all << " " << it->second.args_[i];
+    }
+    all << "\n";
+  }
+  return Helpers::Hash(all.str());
+}
+
+}  // namespace boa
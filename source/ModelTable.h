@@ -0,0 +1,152 @@
+#ifndef __BOA_MODELTABLE_H
+#define __BOA_MODELTABLE_H /* */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "BlameInfo.h"
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace boa {
+
+/**
+  Models of library functions, looked up by function name.
+
+  Models are described by a model specification, one function per line -
+
+    # comment
+    <function> <model> [<argument>...]
+
+  For example "strncpy bounded_write 0 2" - strncpy writes its argument 0 up to the length given by
+  its argument 2. Arguments are the 0 based indices of the call's arguments, unless the model says
+  otherwise. The models are -
+
+    safe                        - a function without a body which doesn't overrun its buffers
+    unsafe                      - a function without a body which is known to overrun its buffers
+    alloc SIZE                  - returns a new buffer of SIZE bytes (malloc)
+    duplicate STRING            - returns a new copy of STRING (strdup)
+    length STRING               - returns the length of STRING (strlen)
+    string_copy DEST SOURCE     - copies the string SOURCE to DEST (strcpy)
+    format DEST FORMAT          - copies FORMAT to DEST when there are no more arguments, writes DEST
+                                  without bound otherwise (sprintf)
+    bounded_write DEST N        - writes N bytes to DEST (strncpy)
+    fixed_write DEST LAST       - writes DEST up to the index LAST, which is a number (pipe)
+    find STRING                 - returns a pointer into STRING (strchr)
+    static_string               - returns a read only static string (strerror)
+    search BUFFER N             - reads N bytes of BUFFER, returns a pointer into them (memchr)
+    compare BUFFER BUFFER N     - reads N bytes of both buffers, returns any integer (memcmp)
+    move DEST SOURCE N          - moves N bytes from SOURCE to DEST, returns DEST (memmove)
+    fill DEST N                 - writes N bytes to DEST (memset)
+    copy DEST SOURCE N          - copies N bytes from SOURCE to DEST, returns DEST (memcpy)
+
+  A function name ending with ".*" models every function named by it and a '.' separated suffix,
+  e.g. "llvm.memcpy.*" models the overloaded intrinsic llvm.memcpy.p0i8.p0i8.i64. Blames name the
+  function without the "llvm." prefix and the ".*" suffix.
+
+  The table is compiled into a perfect hash on every change, so a lookup costs two hashes of the
+  name and a single comparison. The libc models (models/libc.models) are built in, see Libc().
+*/
+class ModelTable {
+ public:
+  enum Kind {
+    SAFE,
+    UNSAFE,
+    ALLOC,
+    DUPLICATE,
+    LENGTH,
+    STRING_COPY,
+    FORMAT,
+    BOUNDED_WRITE,
+    FIXED_WRITE,
+    FIND,
+    STATIC_STRING,
+    SEARCH,
+    COMPARE,
+    MOVE,
+    FILL,
+    COPY
+  };
+
+  static const unsigned MAX_ARGS = 3;
+  static const unsigned MAX_BLAMES = 3;
+
+  struct Model {
+    // The name of the modeled function in blames.
+    string function_;
+    Kind kind_;
+    unsigned args_[MAX_ARGS];
+    unsigned argCount_;
+    // The blames of the constraints generated for a call, interned once - which blame is which
+    // depends on the kind (see KINDS in ModelTable.cpp).
+    BlameMessage blames_[MAX_BLAMES];
+
+    /**
+      Can the model describe a call with "arguments" arguments?
+    */
+    bool Fits(unsigned arguments) const;
+  };
+
+  /**
+    The built in libc models.
+  */
+  static const ModelTable& Libc();
+
+  /**
+    Add the models of spec, replacing earlier models of the same functions. If spec has an error
+    nothing is added, and error is set to "<origin>:<line>: <message>".
+  */
+  bool Add(const string& spec, const string& origin, string* error /* out */);
+
+  /**
+    Add the models of the specification file path.
+  */
+  bool Load(const string& path, string* error /* out */);
+
+  /**
+    The model of function "name" (of length size), NULL if there is none.
+  */
+  const Model* Find(const char* name, size_t size) const;
+
+  const Model* Find(const string& name) const {
+    return Find(name.data(), name.size());
+  }
+
+  size_t Size() const {
+    return models_.size();
+  }
+
+  /**
+    A hash of all the models, which changes whenever any model changes.
+  */
+  uint64_t Fingerprint() const;
+
+ private:
+  // Function name (with the trailing '.' of a ".*" pattern) -> model.
+  map<string, Model> models_;
+
+  // The perfect hash - a key's bucket holds the seed which hashes the key to its slot.
+  vector<uint32_t> seeds_;
+  vector<int> slots_;
+  vector<string> keys_;
+  vector<Model> values_;
+
+  void Compile();
+
+  /**
+    Place the keys of buckets in a table of size slots, a power of 2. Return false if some bucket
+    has no seed.
+  */
+  bool Place(const vector<vector<int> >& buckets, size_t size);
+  const Model* FindKey(const char* key, size_t size) const;
+};
+
+}  // namespace boa
+
+#endif  // __BOA_MODELTABLE_H
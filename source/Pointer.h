@@ -9,6 +9,10 @@ namespace boa {
 
   public:
     Pointer(const Value* node) : VarLiteral(node) {}
+    // A temporary pointer of node, which is not its value.
+    Pointer(const Value* node, bool isTmp) : VarLiteral(node, isTmp) {}
+    // The value at a specific use of an operand, such as a parameter at a call site.
+    explicit Pointer(const Use* use) : VarLiteral(use) {}
   };
 }
 
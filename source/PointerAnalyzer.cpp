@@ -0,0 +1,157 @@
+#include "PointerAnalyzer.h"
+
+#include <deque>
+
+#include "log.h"
+#include "Profiler.h"
+
+using std::deque;
+using std::make_pair;
+
+namespace boa {
+
+const unsigned PointerAnalyzer::UNKNOWN;
+
+PointerAnalyzer::PointerAnalyzer() {
+  NewNode();
+  nodes_[UNKNOWN].pointsTo_.set(UNKNOWN);
+}
+
+unsigned PointerAnalyzer::NewNode() {
+  nodes_.push_back(Node());
+  bufferOf_.push_back(-1);
+  return nodes_.size() - 1;
+}
+
+unsigned PointerAnalyzer::PointerNode(const VarLiteral& pointer) {
+  pair<const void*, bool> key(pointer.Node(), pointer.IsTmp());
+  map<pair<const void*, bool>, unsigned>::iterator it = pointers_.lower_bound(key);
+  if (it != pointers_.end() && it->first == key) {
+    return it->second;
+  }
+  unsigned node = NewNode();
+  pointers_.insert(it, make_pair(key, node));
+  return node;
+}
+
+unsigned PointerAnalyzer::FindPointerNode(const VarLiteral& pointer) const {
+  map<pair<const void*, bool>, unsigned>::const_iterator it =
+      pointers_.find(make_pair(pointer.Node(), pointer.IsTmp()));
+  return (it == pointers_.end()) ? UNKNOWN : it->second;
+}
+
+void PointerAnalyzer::AddBuffer(const Buffer& buffer) {
+  unsigned object = NewNode();
+  bufferOf_[object] = buffers_.size();
+  buffers_.push_back(buffer);
+  nodes_[PointerNode(buffer)].pointsTo_.set(object);
+}
+
+void PointerAnalyzer::AddObject(const VarLiteral& site) {
+  pair<const void*, bool> key(site.Node(), site.IsTmp());
+  if (objects_.count(key)) {
+    return;
+  }
+  unsigned object = NewNode();
+  objects_[key] = object;
+  nodes_[PointerNode(site)].pointsTo_.set(object);
+}
+
+void PointerAnalyzer::AddUnknown(const VarLiteral& pointer) {
+  nodes_[PointerNode(pointer)].pointsTo_.set(UNKNOWN);
+}
+
+void PointerAnalyzer::AddEscape(const VarLiteral& pointer) {
+  nodes_[PointerNode(pointer)].stores_.push_back(UNKNOWN);
+}
+
+void PointerAnalyzer::AddCopy(const VarLiteral& from, const VarLiteral& to) {
+  unsigned fromNode = PointerNode(from), toNode = PointerNode(to);
+  nodes_[fromNode].copies_.set(toNode);
+}
+
+void PointerAnalyzer::AddLoad(const VarLiteral& address, const VarLiteral& to) {
+  unsigned addressNode = PointerNode(address), toNode = PointerNode(to);
+  nodes_[addressNode].loads_.push_back(toNode);
+}
+
+void PointerAnalyzer::AddStore(const VarLiteral& address, const VarLiteral& from) {
+  unsigned addressNode = PointerNode(address), fromNode = PointerNode(from);
+  nodes_[addressNode].stores_.push_back(fromNode);
+}
+
+void PointerAnalyzer::Solve() {
+  ProfileScope scope("PointsTo");
+  deque<unsigned> worklist;
+  vector<bool> queued(nodes_.size(), false);
+  for (unsigned n = 0; n < nodes_.size(); ++n) {
+    if (!nodes_[n].pointsTo_.empty()) {
+      worklist.push_back(n);
+      queued[n] = true;
+    }
+  }
+
+  size_t visits = 0;
+  while (!worklist.empty()) {
+    unsigned n = worklist.front();
+    worklist.pop_front();
+    queued[n] = false;
+    ++visits;
+
+    // Loads and stores through n add copy edges from / to the objects n points to.
+    Node& node = nodes_[n];
+    for (Set::iterator o = node.pointsTo_.begin(); o != node.pointsTo_.end(); ++o) {
+      for (size_t i = 0; i < node.loads_.size(); ++i) {
+        if (nodes_[*o].copies_.test_and_set(node.loads_[i]) && !queued[*o]) {
+          worklist.push_back(*o);
+          queued[*o] = true;
+        }
+      }
+      for (size_t i = 0; i < node.stores_.size(); ++i) {
+        unsigned from = node.stores_[i];
+        if (nodes_[from].copies_.test_and_set(*o) && !queued[from]) {
+          worklist.push_back(from);
+          queued[from] = true;
+        }
+      }
+    }
+
+    for (Set::iterator to = node.copies_.begin(); to != node.copies_.end(); ++to) {
+      if ((nodes_[*to].pointsTo_ |= node.pointsTo_) && !queued[*to]) {
+        worklist.push_back(*to);
+        queued[*to] = true;
+      }
+    }
+  }
+  Profiler::Count("points-to nodes", nodes_.size());
+  Profiler::Count("points-to visits", visits);
+  LOG_DEBUG << "Points-to analysis - " << nodes_.size() << " nodes, " << visits << " visits" <<
+      endl;
+}
+
+void PointerAnalyzer::PointsTo(const VarLiteral& pointer, vector<Buffer>* buffers) const {
+  buffers->clear();
+  unsigned n = FindPointerNode(pointer);
+  if (n == UNKNOWN) {
+    // Nothing was ever assigned to this pointer, it may point anywhere.
+    *buffers = buffers_;
+    return;
+  }
+  const Set& pointsTo = nodes_[n].pointsTo_;
+  if (pointsTo.test(UNKNOWN)) {
+    *buffers = buffers_;
+    return;
+  }
+  for (Set::iterator o = pointsTo.begin(); o != pointsTo.end(); ++o) {
+    if (bufferOf_[*o] != -1) {
+      buffers->push_back(buffers_[bufferOf_[*o]]);
+    }
+  }
+  if (buffers->empty()) {
+    // The pointer was assigned from memory the statements don't describe, so it may point to
+    // any buffer.
+    *buffers = buffers_;
+  }
+}
+
+}  // namespace boa
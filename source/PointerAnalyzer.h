@@ -1,20 +1,116 @@
 #ifndef __BOA_POINTERANALYZER_H
 #define __BOA_POINTERANALYZER_H
 
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/SparseBitVector.h"
+
+#include "Buffer.h"
+#include "VarLiteral.h"
+
+using std::map;
+using std::pair;
+using std::vector;
+
 namespace boa {
 
+/**
+  Inclusion based (Andersen style) points-to analysis.
+
+  Pointers are identified by their VarLiteral, the same way the alias constraints identify them.
+  Memory is modeled by allocation sites - each buffer is a memory object, and AddObject adds the
+  memory of allocations which are not buffers (pointer variables on the stack, for instance). The
+  points-to set of a memory object is the set of pointers stored in it.
+
+  The statements are collected while the constraints are generated, Solve() then propagates the
+  points-to sets over the copy edges with a worklist, adding the edges of loads and stores as the
+  sets of their addresses grow. Points-to sets are sparse bit vectors of node numbers.
+
+  Memory the analysis does not see (results of unknown functions, integers cast to pointers) is a
+  single "unknown" object, a pointer which may point to it may point to any buffer.
+*/
 class PointerAnalyzer {
- private:
-  set<Buffer> buffers_;
-  
  public:
-  void SetBuffers(const set<Buffer> &buffers) {
-    buffers_ = buffers;
-  }
-  
-  const set<Buffer>& PointsTo(const Pointer&) {
-    return buffers_;
-  }
+  PointerAnalyzer();
+
+  /**
+    buffer is a memory object, and the pointer of the same VarLiteral points to it.
+  */
+  void AddBuffer(const Buffer& buffer);
+
+  /**
+    site is the address of memory which is not a buffer.
+  */
+  void AddObject(const VarLiteral& site);
+
+  /**
+    pointer may point to memory the analysis does not see.
+  */
+  void AddUnknown(const VarLiteral& pointer);
+
+  /**
+    The memory pointed by pointer may be overwritten with unknown pointers (passed to an unknown
+    function).
+  */
+  void AddEscape(const VarLiteral& pointer);
+
+  /**
+    to = from (possibly with an offset) - to points to everything from points to.
+  */
+  void AddCopy(const VarLiteral& from, const VarLiteral& to);
+
+  /**
+    to = *address
+  */
+  void AddLoad(const VarLiteral& address, const VarLiteral& to);
+
+  /**
+    *address = from
+  */
+  void AddStore(const VarLiteral& address, const VarLiteral& from);
+
+  /**
+    Compute the points-to sets of all the pointers.
+  */
+  void Solve();
+
+  /**
+    The buffers pointer may point to, valid after Solve(). Every buffer if pointer may point to
+    unknown memory, or if no buffer reaches it at all - the statements don't cover every
+    assignment (e.g. of memory written by code which was not analyzed), so a pointer to nothing
+    is not trusted.
+  */
+  void PointsTo(const VarLiteral& pointer, vector<Buffer>* buffers /* out */) const;
+
+ private:
+  typedef llvm::SparseBitVector<> Set;
+
+  struct Node {
+    // Memory objects this node points to.
+    Set pointsTo_;
+    // Nodes which point to everything this node points to.
+    Set copies_;
+    // to = *this
+    vector<unsigned> loads_;
+    // *this = from
+    vector<unsigned> stores_;
+  };
+
+  // Node 0 is the unknown memory object, which is also a pointer to itself.
+  static const unsigned UNKNOWN = 0;
+
+  vector<Node> nodes_;
+  map<pair<const void*, bool>, unsigned> pointers_;
+  map<pair<const void*, bool>, unsigned> objects_;
+  // Buffer objects, and the buffer of each buffer object node (-1 for other nodes).
+  vector<Buffer> buffers_;
+  vector<int> bufferOf_;
+
+  unsigned NewNode();
+  unsigned PointerNode(const VarLiteral& pointer);
+  unsigned FindPointerNode(const VarLiteral& pointer) const;
 };
 
 }  // namespace boa
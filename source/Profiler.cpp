@@ -0,0 +1,115 @@
+#include "Profiler.h"
+
+#include <sys/time.h>
+#include <time.h>
+
+#include "Helpers.h"
+
+namespace boa {
+
+bool Profiler::enabled_ = false;
+pthread_t Profiler::owner_;
+pthread_mutex_t Profiler::countersMutex_ = PTHREAD_MUTEX_INITIALIZER;
+vector<Profiler::Node> Profiler::nodes_;
+int Profiler::current_ = -1;
+
+static double WallMs() {
+  timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+static double CpuMs() {
+  return (1000.0 * clock()) / CLOCKS_PER_SEC;
+}
+
+void Profiler::Enable() {
+  if (enabled_) {
+    return;
+  }
+  Clear();
+  enabled_ = true;
+  owner_ = pthread_self();
+  Begin("boa");
+}
+
+void Profiler::Begin(const char* phase) {
+  int node;
+  if (current_ == -1) {
+    node = nodes_.size();
+    nodes_.push_back(Node(phase, -1));
+  } else {
+    map<string, int>::iterator it = nodes_[current_].children_.find(phase);
+    if (it != nodes_[current_].children_.end()) {
+      node = it->second;
+    } else {
+      node = nodes_.size();
+      // nodes_ may be reallocated, don't hold references into it across push_back.
+      nodes_.push_back(Node(phase, current_));
+      nodes_[current_].children_[phase] = node;
+      nodes_[current_].childOrder_.push_back(node);
+    }
+  }
+  nodes_[node].calls_++;
+  nodes_[node].wallStart_ = WallMs();
+  nodes_[node].cpuStart_ = CpuMs();
+  current_ = node;
+}
+
+void Profiler::End() {
+  if (current_ == -1) {
+    return;
+  }
+  Node& node = nodes_[current_];
+  node.wallMs_ += WallMs() - node.wallStart_;
+  node.cpuMs_ += CpuMs() - node.cpuStart_;
+  current_ = node.parent_;
+}
+
+void Profiler::AddCounter(const char* name, long value) {
+  pthread_mutex_lock(&countersMutex_);
+  if (current_ != -1) {
+    nodes_[current_].counters_[name] += value;
+  }
+  pthread_mutex_unlock(&countersMutex_);
+}
+
+void Profiler::WriteNode(ostream& os, int node, int indent) {
+  const Node& n = nodes_[node];
+  string pad(indent, ' ');
+  os << pad << "{ \"name\": ";
+  os << Helpers::JsonString(n.name_);
+  os << ", \"calls\": " << n.calls_ << ", \"wall_ms\": " << n.wallMs_
+     << ", \"cpu_ms\": " << n.cpuMs_ << "," << std::endl;
+  os << pad << "  \"counters\": {";
+  for (map<string, long>::const_iterator it = n.counters_.begin(); it != n.counters_.end(); ++it) {
+    os << (it == n.counters_.begin() ? " " : ", ");
+    os << Helpers::JsonString(it->first);
+    os << ": " << it->second;
+  }
+  os << (n.counters_.empty() ? "}," : " },") << std::endl;
+  os << pad << "  \"children\": [";
+  for (size_t i = 0; i < n.childOrder_.size(); ++i) {
+    os << (i == 0 ? "" : ",") << std::endl;
+    WriteNode(os, n.childOrder_[i], indent + 4);
+  }
+  os << (n.childOrder_.empty() ? "" : "\n" + pad + "  ") << "] }";
+}
+
+void Profiler::WriteJson(ostream& os) {
+  while (current_ != -1) {
+    End();
+  }
+  if (!nodes_.empty()) {
+    WriteNode(os, 0, 0);
+    os << std::endl;
+  }
+}
+
+void Profiler::Clear() {
+  enabled_ = false;
+  nodes_.clear();
+  current_ = -1;
+}
+
+}  // namespace boa
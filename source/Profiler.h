@@ -0,0 +1,140 @@
+#ifndef __BOA_PROFILER_H
+#define __BOA_PROFILER_H /* */
+
+#include <pthread.h>
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using std::map;
+using std::ostream;
+using std::string;
+using std::vector;
+
+namespace boa {
+
+/**
+  Hierarchical phase profiler.
+
+  Phases are timed with ProfileScope objects, nested scopes become children of the enclosing one.
+  Entering the same phase several times under the same parent is accumulated into a single node,
+  which counts the number of calls. Counters (rows, GLPK iterations, ...) are added to the
+  innermost open phase.
+
+  Only the thread which enabled the profiler is timed, scopes on worker threads are ignored.
+  Counters of worker threads are added to the innermost open phase of the profiled thread, which is
+  waiting for the workers (see ThreadPool).
+
+  The profiler is disabled by default, and then costs a single branch per scope or counter. Enable
+  it with the -profile=<file> flag, the result is written as JSON -
+
+  { "name": "boa", "calls": 1, "wall_ms": 12.5, "cpu_ms": 12.1,
+    "counters": { "rows": 120 }, "children": [ ... ] }
+*/
+class Profiler {
+ public:
+  static void Enable();
+
+  /**
+    Is the calling thread profiled?
+  */
+  static bool Enabled() {
+    return enabled_ && pthread_equal(owner_, pthread_self());
+  }
+
+  /**
+    Open a phase as a child of the innermost open phase. Prefer ProfileScope.
+  */
+  static void Begin(const char* phase);
+
+  /**
+    Close the innermost open phase.
+  */
+  static void End();
+
+  /**
+    Add value to the counter "name" of the innermost open phase.
+  */
+  static void Count(const char* name, long value) {
+    if (enabled_) {
+      AddCounter(name, value);
+    }
+  }
+
+  /**
+    Close all open phases and write the profile as JSON.
+  */
+  static void WriteJson(ostream& os);
+
+  /**
+    Forget all phases and disable the profiler.
+  */
+  static void Clear();
+
+ private:
+  struct Node {
+    string name_;
+    int parent_;
+    long calls_;
+    double wallMs_, cpuMs_;
+    // Start time of the current call
+    double wallStart_, cpuStart_;
+    map<string, int> children_;
+    // Insertion order of the children, so the output follows execution order.
+    vector<int> childOrder_;
+    map<string, long> counters_;
+
+    Node(const string& name, int parent) :
+      name_(name), parent_(parent), calls_(0), wallMs_(0), cpuMs_(0), wallStart_(0),
+      cpuStart_(0) {}
+  };
+
+  static void AddCounter(const char* name, long value);
+  static void WriteNode(ostream& os, int node, int indent);
+
+  static bool enabled_;
+  static pthread_t owner_;
+  static pthread_mutex_t countersMutex_;
+  static vector<Node> nodes_;
+  static int current_;
+};
+
+/**
+  Time the enclosing block as a profiler phase.
+
+  Usage:
+
+    {
+      ProfileScope scope("ElasticFilter");
+      [...]
+    }
+*/
+class ProfileScope {
+ public:
+  explicit ProfileScope(const char* phase) {
+    if (Profiler::Enabled()) {
+      Profiler::Begin(phase);
+      open_ = true;
+    } else {
+      open_ = false;
+    }
+  }
+
+  ~ProfileScope() {
+    if (open_) {
+      Profiler::End();
+    }
+  }
+
+ private:
+  bool open_;
+
+  ProfileScope(const ProfileScope&);
+  ProfileScope& operator=(const ProfileScope&);
+};
+
+}  // namespace boa
+
+#endif  // __BOA_PROFILER_H
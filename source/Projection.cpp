@@ -0,0 +1,140 @@
+#include "Projection.h"
+
+#include <math.h>
+
+#include <utility>
+
+using std::make_pair;
+using std::pair;
+
+namespace boa {
+
+static const double EPSILON = 1e-9;
+
+bool Projection::Project(const vector<bool>& keep) {
+  for (size_t i = 0; i < rows_.size(); ++i) {
+    Normalize(&rows_[i]);
+  }
+  while (true) {
+    // Number of positive and negative occurrences of every variable which should be eliminated.
+    map<VarId, pair<size_t, size_t> > occurrences;
+    for (size_t i = 0; i < rows_.size(); ++i) {
+      const map<VarId, double>& coefs = rows_[i].coefs_;
+      for (map<VarId, double>::const_iterator it = coefs.begin(); it != coefs.end(); ++it) {
+        if (it->first.Index() < keep.size() && keep[it->first.Index()]) {
+          continue;
+        }
+        pair<size_t, size_t>& count = occurrences[it->first];
+        if (it->second > 0) {
+          ++count.first;
+        } else {
+          ++count.second;
+        }
+      }
+    }
+    if (occurrences.empty()) {
+      return true;
+    }
+
+    map<VarId, pair<size_t, size_t> >::const_iterator best = occurrences.begin();
+    double bestGrowth = 0;
+    for (map<VarId, pair<size_t, size_t> >::const_iterator it = occurrences.begin();
+         it != occurrences.end(); ++it) {
+      double growth = double(it->second.first) * it->second.second -
+                      double(it->second.first) - it->second.second;
+      if (it == occurrences.begin() || growth < bestGrowth) {
+        best = it;
+        bestGrowth = growth;
+      }
+    }
+    if (!Eliminate(best->first) || rows_.size() > maxRows_) {
+      return false;
+    }
+  }
+}
+
+bool Projection::Eliminate(VarId var) {
+  vector<Row> positive, negative, rows;
+  for (size_t i = 0; i < rows_.size(); ++i) {
+    map<VarId, double>::const_iterator it = rows_[i].coefs_.find(var);
+    if (it == rows_[i].coefs_.end()) {
+      rows.push_back(rows_[i]);
+    } else if (it->second > 0) {
+      positive.push_back(rows_[i]);
+    } else {
+      negative.push_back(rows_[i]);
+    }
+  }
+
+  for (size_t p = 0; p < positive.size(); ++p) {
+    for (size_t n = 0; n < negative.size(); ++n) {
+      // positive * b + negative * a, where a > 0 and -b < 0 are the coefficients of var.
+      double a = positive[p].coefs_[var], b = -negative[n].coefs_[var];
+      Row row;
+      for (map<VarId, double>::const_iterator it = positive[p].coefs_.begin();
+           it != positive[p].coefs_.end(); ++it) {
+        row.coefs_[it->first] += it->second * b;
+      }
+      for (map<VarId, double>::const_iterator it = negative[n].coefs_.begin();
+           it != negative[n].coefs_.end(); ++it) {
+        row.coefs_[it->first] += it->second * a;
+      }
+      row.coefs_.erase(var);
+      row.left_ = positive[p].left_ * b + negative[n].left_ * a;
+      row.type_ = (positive[p].type_ > negative[n].type_) ? positive[p].type_ : negative[n].type_;
+      Normalize(&row);
+      if (row.coefs_.empty()) {
+        if (row.left_ < -EPSILON) {
+          return false;
+        }
+        continue;
+      }
+      rows.push_back(row);
+    }
+  }
+  rows_.swap(rows);
+  RemoveDuplicates();
+  return true;
+}
+
+void Projection::Normalize(Row* row) {
+  double scale = 0;
+  for (map<VarId, double>::iterator it = row->coefs_.begin(); it != row->coefs_.end();) {
+    if (fabs(it->second) < EPSILON) {
+      row->coefs_.erase(it++);
+      continue;
+    }
+    if (fabs(it->second) > scale) {
+      scale = fabs(it->second);
+    }
+    ++it;
+  }
+  if (scale == 0) {
+    return;
+  }
+  for (map<VarId, double>::iterator it = row->coefs_.begin(); it != row->coefs_.end(); ++it) {
+    it->second /= scale;
+  }
+  row->left_ /= scale;
+}
+
+void Projection::RemoveDuplicates() {
+  map<map<VarId, double>, size_t> index;
+  vector<Row> rows;
+  for (size_t i = 0; i < rows_.size(); ++i) {
+    map<map<VarId, double>, size_t>::iterator it = index.find(rows_[i].coefs_);
+    if (it == index.end()) {
+      index.insert(make_pair(rows_[i].coefs_, rows.size()));
+      rows.push_back(rows_[i]);
+      continue;
+    }
+    Row& kept = rows[it->second];
+    if (rows_[i].left_ < kept.left_) {
+      kept.left_ = rows_[i].left_;
+      kept.type_ = rows_[i].type_;
+    }
+  }
+  rows_.swap(rows);
+}
+
+}  // namespace boa
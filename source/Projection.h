@@ -0,0 +1,84 @@
+#ifndef __BOA_PROJECTION_H
+#define __BOA_PROJECTION_H /* */
+
+#include <stddef.h>
+
+#include <map>
+#include <vector>
+
+#include "Constraint.h"
+#include "VarTable.h"
+
+using std::map;
+using std::vector;
+
+namespace boa {
+
+/**
+  Projection of a system of rows left >= aX + bY ... onto some of its variables, by Fourier-Motzkin
+  elimination.
+
+  Eliminating X combines every row where X has a positive coefficient with every row where it has
+  a negative one, so that X cancels. The resulting rows are exactly the constraints the system
+  implies on the other variables. The number of rows may grow quickly, the projection gives up once
+  it has more than maxRows rows.
+
+  Variables are eliminated in the order which adds the fewest rows. Rows are scaled so that their
+  largest coefficient is 1, and duplicate rows keep only the smallest left side. A combined row
+  has the highest Constraint::Type of the rows it was made of.
+*/
+class Projection {
+ public:
+  struct Row {
+    map<VarId, double> coefs_;
+    double left_;
+    Constraint::Type type_;
+
+    Row() : left_(0.0), type_(Constraint::STRUCTURAL) {}
+  };
+
+  explicit Projection(size_t maxRows) : maxRows_(maxRows) {}
+
+  void AddRow(const Row& row) {
+    rows_.push_back(row);
+  }
+
+  /**
+    Eliminate every variable for which keep(var) is false - keep is indexed by VarId, variables
+    beyond its end are eliminated.
+
+    Return false if the projection needs more than maxRows rows, or if the rows are infeasable.
+  */
+  bool Project(const vector<bool>& keep);
+
+  size_t Size() const {
+    return rows_.size();
+  }
+
+  const Row& GetRow(size_t row) const {
+    return rows_[row];
+  }
+
+ private:
+  size_t maxRows_;
+  vector<Row> rows_;
+
+  /**
+    Eliminate var from all the rows. Return false if a row without variables is violated.
+  */
+  bool Eliminate(VarId var);
+
+  /**
+    Scale row so its largest coefficient is 1, dropping zero coefficients.
+  */
+  static void Normalize(Row* row /* in, out */);
+
+  /**
+    Remove duplicate rows, keeping the smallest left side of each.
+  */
+  void RemoveDuplicates();
+};
+
+}  // namespace boa
+
+#endif  // __BOA_PROJECTION_H
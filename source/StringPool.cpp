@@ -0,0 +1,22 @@
+#include "StringPool.h"
+
+namespace boa {
+
+uint32_t StringPool::Intern(const string& str) {
+  map<string, uint32_t>::iterator it = ids_.lower_bound(str);
+  if (it != ids_.end() && it->first == str) {
+    return it->second;
+  }
+  uint32_t id = strings_.size();
+  ids_.insert(it, std::make_pair(str, id));
+  strings_.push_back(str);
+  return id;
+}
+
+void StringPool::Clear() {
+  ids_.clear();
+  strings_.clear();
+  Intern("");
+}
+
+}  // namespace boa
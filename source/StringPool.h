@@ -0,0 +1,41 @@
+#ifndef __BOA_STRINGPOOL_H
+#define __BOA_STRINGPOOL_H /* */
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace boa {
+
+/**
+  A set of interned strings - each distinct string is stored once and identified by a dense id.
+
+  The id 0 is always the empty string.
+*/
+class StringPool {
+  map<string, uint32_t> ids_;
+  vector<string> strings_;
+
+ public:
+  StringPool() {
+    Intern("");
+  }
+
+  uint32_t Intern(const string& str);
+
+  const string& Get(uint32_t id) const {
+    return strings_[id];
+  }
+
+  void Clear();
+};
+
+}  // namespace boa
+
+#endif  // __BOA_STRINGPOOL_H
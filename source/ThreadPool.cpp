@@ -0,0 +1,141 @@
+#include "ThreadPool.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include <sstream>
+#include <string>
+
+#include <glpk.h>
+
+#include "log.h"
+
+using std::string;
+using std::stringstream;
+
+// glpk keeps its environment in thread local storage since version 4.57, older versions share a
+// single environment and can only be used from one thread.
+#if (GLP_MAJOR_VERSION > 4) || (GLP_MAJOR_VERSION == 4 && GLP_MINOR_VERSION >= 57)
+#define BOA_GLPK_THREADS 1
+#else
+#define BOA_GLPK_THREADS 0
+#endif
+
+namespace boa {
+
+namespace {
+
+struct Work {
+  vector<Job*> jobs_;
+  vector<string> logs_;
+  size_t next_;
+  // Jobs which were started and not yet observed, they may still add jobs.
+  int running_;
+  JobObserver* observer_;
+  pthread_mutex_t mutex_;
+  pthread_cond_t changed_;
+};
+
+void* Worker(void* arg) {
+  Work* work = static_cast<Work*>(arg);
+  pthread_mutex_lock(&work->mutex_);
+  while (true) {
+    if (work->next_ == work->jobs_.size()) {
+      if (work->running_ == 0) {
+        break;
+      }
+      pthread_cond_wait(&work->changed_, &work->mutex_);
+      continue;
+    }
+    size_t i = work->next_++;
+    Job* job = work->jobs_[i];
+    ++work->running_;
+    pthread_mutex_unlock(&work->mutex_);
+
+    stringstream jobLog;
+    log::setThreadStream(&jobLog);
+    job->Run();
+    pthread_mutex_lock(&work->mutex_);
+    if (work->observer_ != NULL) {
+      vector<Job*> more;
+      work->observer_->Done(job, &more);
+      work->jobs_.insert(work->jobs_.end(), more.begin(), more.end());
+      work->logs_.resize(work->jobs_.size());
+    }
+    log::setThreadStream(NULL);
+    work->logs_[i] = jobLog.str();
+    --work->running_;
+    pthread_cond_broadcast(&work->changed_);
+  }
+  pthread_mutex_unlock(&work->mutex_);
+  glp_free_env();
+  return NULL;
+}
+
+void RunSerially(const vector<Job*>& jobs, JobObserver* observer) {
+  vector<Job*> queue(jobs);
+  for (size_t i = 0; i < queue.size(); ++i) {
+    queue[i]->Run();
+    if (observer != NULL) {
+      vector<Job*> more;
+      observer->Done(queue[i], &more);
+      queue.insert(queue.end(), more.begin(), more.end());
+    }
+  }
+}
+
+}  // namespace
+
+int ThreadPool::DefaultThreads() {
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return (n > 0) ? n : 1;
+}
+
+void ThreadPool::Run(const vector<Job*>& jobs, int threads, JobObserver* observer) {
+  if (!BOA_GLPK_THREADS) {
+    threads = 1;
+  }
+  // Jobs added by the observer may use the other threads.
+  if (threads > static_cast<int>(jobs.size()) && (observer == NULL || jobs.empty())) {
+    threads = jobs.size();
+  }
+  if (threads <= 1) {
+    RunSerially(jobs, observer);
+    return;
+  }
+
+  Work work;
+  work.jobs_ = jobs;
+  work.logs_.resize(jobs.size());
+  work.next_ = 0;
+  work.running_ = 0;
+  work.observer_ = observer;
+  pthread_mutex_init(&work.mutex_, NULL);
+  pthread_cond_init(&work.changed_, NULL);
+
+  vector<pthread_t> workers(threads);
+  int started = 0;
+  for (int i = 0; i < threads; ++i) {
+    if (pthread_create(&workers[started], NULL, &Worker, &work) == 0) {
+      ++started;
+    }
+  }
+  if (started == 0) {
+    // Could not create any thread, run on this one.
+    LOG_ERROR << "Can't create worker threads, running " << jobs.size() << " jobs serially" << endl;
+    RunSerially(jobs, observer);
+  }
+  for (int i = 0; i < started; ++i) {
+    pthread_join(workers[i], NULL);
+  }
+  pthread_cond_destroy(&work.changed_);
+  pthread_mutex_destroy(&work.mutex_);
+
+  if (log::enabled(log::Error)) {
+    for (size_t i = 0; i < work.logs_.size(); ++i) {
+      log::os() << work.logs_[i];
+    }
+  }
+}
+
+}  // namespace boa
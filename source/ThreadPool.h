@@ -0,0 +1,62 @@
+#ifndef __BOA_THREADPOOL_H
+#define __BOA_THREADPOOL_H /* */
+
+#include <stddef.h>
+
+#include <vector>
+
+using std::vector;
+
+namespace boa {
+
+/**
+  A unit of work for ThreadPool.
+*/
+class Job {
+ public:
+  virtual ~Job() {}
+  virtual void Run() = 0;
+};
+
+/**
+  Told about the jobs of ThreadPool::Run as they are done.
+*/
+class JobObserver {
+ public:
+  virtual ~JobObserver() {}
+
+  /**
+    Called once job is done, for one job at a time. Jobs added to "more" are run by the same pool
+    before Run returns, and are observed too.
+  */
+  virtual void Done(Job* job, vector<Job*>* more /* out */) = 0;
+};
+
+/**
+  Run independent jobs on a pool of worker threads.
+
+  Jobs must not share mutable state. The log output of each job is buffered and written to the log
+  in job order once all the jobs are done, so the log does not depend on scheduling.
+
+  Each worker thread has its own glpk environment (glpk keeps it in thread local storage), which is
+  freed when the worker exits. Problems created by a job must be deleted by the same job. With glpk
+  versions which are not thread safe, all jobs run on the calling thread.
+*/
+class ThreadPool {
+ public:
+  /**
+    The number of online processors, at least 1.
+  */
+  static int DefaultThreads();
+
+  /**
+    Run all jobs using up to "threads" worker threads, return when all of them are done. With a
+    single thread (or a single job) the jobs run on the calling thread. observer, if given, is
+    called on the thread which ran the job.
+  */
+  static void Run(const vector<Job*>& jobs, int threads, JobObserver* observer = NULL);
+};
+
+}  // namespace boa
+
+#endif  // __BOA_THREADPOOL_H
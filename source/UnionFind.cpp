@@ -0,0 +1,41 @@
+#include "UnionFind.h"
+
+namespace boa {
+
+UnionFind::UnionFind(size_t n) : parent_(n), rank_(n, 0) {
+  for (size_t i = 0; i < n; ++i) {
+    parent_[i] = i;
+  }
+}
+
+uint32_t UnionFind::Find(uint32_t element) {
+  uint32_t root = element;
+  while (parent_[root] != root) {
+    root = parent_[root];
+  }
+  // Path compression
+  while (parent_[element] != root) {
+    uint32_t next = parent_[element];
+    parent_[element] = root;
+    element = next;
+  }
+  return root;
+}
+
+void UnionFind::Union(uint32_t a, uint32_t b) {
+  a = Find(a);
+  b = Find(b);
+  if (a == b) {
+    return;
+  }
+  if (rank_[a] < rank_[b]) {
+    parent_[a] = b;
+  } else if (rank_[a] > rank_[b]) {
+    parent_[b] = a;
+  } else {
+    parent_[b] = a;
+    ++rank_[a];
+  }
+}
+
+}  // namespace boa
@@ -0,0 +1,40 @@
+#ifndef __BOA_UNIONFIND_H
+#define __BOA_UNIONFIND_H /* */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+using std::vector;
+
+namespace boa {
+
+/**
+  Disjoint sets over the elements 0..n-1, with path compression and union by rank.
+*/
+class UnionFind {
+  vector<uint32_t> parent_;
+  vector<uint8_t> rank_;
+
+ public:
+  explicit UnionFind(size_t n);
+
+  /**
+    The representative of the set containing element.
+  */
+  uint32_t Find(uint32_t element);
+
+  /**
+    Merge the sets containing a and b.
+  */
+  void Union(uint32_t a, uint32_t b);
+
+  size_t Size() const {
+    return parent_.size();
+  }
+};
+
+}  // namespace boa
+
+#endif  // __BOA_UNIONFIND_H
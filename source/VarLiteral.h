@@ -3,10 +3,10 @@
 
 #include "llvm/Value.h"
 #include <string>
-#include <sstream>
+
+#include "VarTable.h"
 
 using std::string;
-using std::stringstream;
 
 using namespace llvm;
 
@@ -53,22 +53,26 @@ namespace boa {
 
    public:
 
-    virtual string getUniqueName() const {
-      stringstream ss;
-      if (isTmp_) {
-        ss << "temp@" << ValueNode_;
-      } else {      
-        ss << "v@" << ValueNode_;
-      }
-      return ss.str();
+    /**
+      The linear problem variable describing the given bound of this literal, see VarTable.
+    */
+    virtual VarId NameExpression(ExpressionDir dir, ExpressionType type) const {
+      return VarTable::Intern(ValueNode_, isTmp_, type, dir);
     }
 
-    virtual string NameExpression(ExpressionDir dir, ExpressionType type) const {
-      return getUniqueName() + "!" + TypeToString(type) + "!" + DirToString(dir);
+    /**
+      The same variable, which must already be interned (see VarTable::Find).
+    */
+    VarId FindExpression(ExpressionDir dir, ExpressionType type) const {
+      return VarTable::Find(ValueNode_, isTmp_, type, dir);
     }
 
     virtual bool IsBuffer() const { return false; }
 
+    const void* Node() const { return ValueNode_; }
+
+    bool IsTmp() const { return isTmp_; }
+
     virtual bool operator<(const VarLiteral& other) const {
       if (this->ValueNode_ == other.ValueNode_) {
         return this->isTmp_ < other.isTmp_;
@@ -0,0 +1,75 @@
+#include "VarTable.h"
+
+#include <assert.h>
+
+#include <sstream>
+
+#include "VarLiteral.h"
+
+using std::stringstream;
+
+namespace boa {
+
+map<VarTable::Key, VarId> VarTable::ids_;
+vector<VarTable::Key> VarTable::keys_;
+
+VarId VarTable::Intern(const void* node, bool isTmp, int type, int dir) {
+  Key key(node, isTmp, type, dir);
+  map<Key, VarId>::iterator it = ids_.lower_bound(key);
+  if (it != ids_.end() && !(key < it->first)) {
+    return it->second;
+  }
+  VarId id(keys_.size());
+  ids_.insert(it, std::make_pair(key, id));
+  keys_.push_back(key);
+  return id;
+}
+
+VarId VarTable::Find(const void* node, bool isTmp, int type, int dir) {
+  map<Key, VarId>::const_iterator it = ids_.find(Key(node, isTmp, type, dir));
+  assert(it != ids_.end());
+  return it->second;
+}
+
+uint32_t VarTable::Size() {
+  return keys_.size();
+}
+
+bool VarTable::IsMax(VarId var) {
+  return keys_[var.Index()].dir_ == VarLiteral::MAX;
+}
+
+const void* VarTable::Node(VarId var) {
+  return keys_[var.Index()].node_;
+}
+
+bool VarTable::IsTmp(VarId var) {
+  return keys_[var.Index()].isTmp_;
+}
+
+int VarTable::Type(VarId var) {
+  return keys_[var.Index()].type_;
+}
+
+VarId VarTable::Rename(VarId var, const void* node) {
+  const Key& key = keys_[var.Index()];
+  return Intern(node, key.isTmp_, key.type_, key.dir_);
+}
+
+string VarTable::Name(VarId var) {
+  const Key& key = keys_[var.Index()];
+  stringstream ss;
+  ss << (key.isTmp_ ? "temp@" : "v@") << key.node_ << "!";
+  if (key.type_ != NO_TYPE) {
+    ss << VarLiteral::TypeToString(static_cast<VarLiteral::ExpressionType>(key.type_)) << "!";
+  }
+  ss << VarLiteral::DirToString(static_cast<VarLiteral::ExpressionDir>(key.dir_));
+  return ss.str();
+}
+
+void VarTable::Clear() {
+  ids_.clear();
+  keys_.clear();
+}
+
+}  // namespace boa
@@ -0,0 +1,133 @@
+#ifndef __BOA_VARTABLE_H
+#define __BOA_VARTABLE_H /* */
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace boa {
+
+/**
+  A dense identifier of a single variable in the linear problem.
+
+  The n'th variable interned by the VarTable gets the id n, so ids can be used directly as indices
+  into arrays. The explicit constructor prevents a numeric constant from silently becoming a
+  variable when building a Constraint::Expression.
+*/
+class VarId {
+  uint32_t id_;
+
+ public:
+  VarId() : id_(0) {}
+  explicit VarId(uint32_t id) : id_(id) {}
+
+  uint32_t Index() const {
+    return id_;
+  }
+
+  bool operator<(const VarId& other) const {
+    return id_ < other.id_;
+  }
+
+  bool operator==(const VarId& other) const {
+    return id_ == other.id_;
+  }
+
+  bool operator!=(const VarId& other) const {
+    return id_ != other.id_;
+  }
+};
+
+/**
+  Symbol table of the linear problem variables.
+
+  A variable is identified by the llvm node it describes, whether it is a temporary, its
+  VarLiteral::ExpressionType and its VarLiteral::ExpressionDir. Integers have no expression type,
+  they are interned with NO_TYPE.
+
+  Names are rendered only on demand (logs and blame output), in the same format previously used as
+  the variable key - "v@0x1234!len-write!max", "temp@0x1234!alloc!min" or "v@0x1234!max".
+*/
+class VarTable {
+ public:
+  static const int NO_TYPE = -1;
+
+  /**
+    Return the id of the given variable, creating a new one if it was not seen before.
+  */
+  static VarId Intern(const void* node, bool isTmp, int type, int dir);
+
+  /**
+    Return the id of a variable which was already interned. Unlike Intern it never modifies the
+    table, so it may be called from several threads as long as no thread interns meanwhile.
+  */
+  static VarId Find(const void* node, bool isTmp, int type, int dir);
+
+  /**
+    Number of variables interned so far, all ids are smaller than this value.
+  */
+  static uint32_t Size();
+
+  /**
+    Is this the upper bound (VarLiteral::MAX) of a value?
+  */
+  static bool IsMax(VarId var);
+
+  /**
+    The llvm node the variable describes.
+  */
+  static const void* Node(VarId var);
+
+  static bool IsTmp(VarId var);
+
+  /**
+    The VarLiteral::ExpressionType of the variable, NO_TYPE for integers.
+  */
+  static int Type(VarId var);
+
+  /**
+    The variable which describes the same bound as var, of another node.
+  */
+  static VarId Rename(VarId var, const void* node);
+
+  /**
+    A readable name of the variable, for logs and blame output.
+  */
+  static string Name(VarId var);
+
+  /**
+    Forget all variables. Ids handed before calling Clear must not be used afterwards.
+  */
+  static void Clear();
+
+ private:
+  struct Key {
+    const void* node_;
+    bool isTmp_;
+    int type_;
+    int dir_;
+
+    Key(const void* node, bool isTmp, int type, int dir) :
+      node_(node), isTmp_(isTmp), type_(type), dir_(dir) {}
+
+    bool operator<(const Key& other) const {
+      if (node_ != other.node_) return node_ < other.node_;
+      if (isTmp_ != other.isTmp_) return isTmp_ < other.isTmp_;
+      if (type_ != other.type_) return type_ < other.type_;
+      return dir_ < other.dir_;
+    }
+  };
+
+  static map<Key, VarId> ids_;
+  static vector<Key> keys_;
+};
+
+}  // namespace boa
+
+#endif  // __BOA_VARTABLE_H
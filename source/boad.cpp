@@ -0,0 +1,274 @@
+// boad - the boa daemon.
+//
+// Analyzing a single file with the boa script pays for starting clang and opt and for loading the
+// pass every time, and the caches start empty. boad is started once, with the usual boa flags,
+// and analyzes the files it is sent over a Unix socket:
+//
+//   boad -socket=/tmp/boa.sock -blame &
+//   boad -client -socket=/tmp/boa.sock file.c other.bc
+//
+// A request is a list of paths, one per line, ended by an empty line. Bitcode files (.bc) are read
+// directly, other files are compiled to bitcode with -clang. The files of a request are linked
+// into a single module and analyzed together, and the report is sent back before the connection
+// is closed. The request "-quit" (boad -client -quit) stops the daemon.
+//
+// Interned strings, locations and the constraints of every function already generated (see
+// ConstraintCache) are kept between requests.
+
+#include "llvm/LLVMContext.h"
+#include "llvm/Linker.h"
+#include "llvm/Module.h"
+#include "llvm/PassManager.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/system_error.h"
+#include "llvm/Transforms/Scalar.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Analyzer.h"
+#include "log.h"
+
+using std::cerr;
+using std::endl;
+using std::string;
+using std::stringstream;
+using std::vector;
+
+using namespace llvm;
+
+static cl::opt<string> Socket("socket", cl::desc("Unix socket of the daemon"),
+                              cl::value_desc("path"), cl::init("boad.sock"));
+static cl::opt<bool> Client("client", cl::desc("Send the files to a running daemon"));
+static cl::opt<bool> Quit("quit", cl::desc("With -client, stop the daemon"));
+static cl::opt<string> Clang("clang", cl::desc("Compiler for files which are not bitcode"),
+                             cl::value_desc("path"), cl::init("clang"));
+static cl::list<string> Files(cl::Positional, cl::desc("<files>"));
+
+namespace boa {
+
+static const string QUIT("-quit");
+
+static bool Connect(int fd, bool listen) {
+  sockaddr_un address;
+  if (Socket.size() >= sizeof(address.sun_path)) {
+    cerr << "socket path too long - " << Socket << endl;
+    return false;
+  }
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, Socket.c_str());
+  sockaddr* generic = reinterpret_cast<sockaddr*>(&address);
+  if (!listen) {
+    return connect(fd, generic, sizeof(address)) == 0;
+  }
+  unlink(Socket.c_str());
+  return bind(fd, generic, sizeof(address)) == 0 && ::listen(fd, SOMAXCONN) == 0;
+}
+
+static bool WriteAll(int fd, const string& data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t n = write(fd, data.data() + written, data.size() - written);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    written += n;
+  }
+  return true;
+}
+
+/**
+  Read lines until an empty line or the end of the input.
+*/
+static void ReadRequest(int fd, vector<string>* lines /* out */) {
+  string line;
+  char c;
+  while (true) {
+    ssize_t n = read(fd, &c, 1);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0 || (c == '\n' && line.empty())) {
+      return;
+    }
+    if (c == '\n') {
+      lines->push_back(line);
+      line.clear();
+    } else {
+      line += c;
+    }
+  }
+}
+
+/**
+  Compile source to bitcode file "bitcode" with -clang.
+*/
+static bool Compile(const string& source, const string& bitcode) {
+  pid_t pid = fork();
+  if (pid == 0) {
+    execlp(Clang.c_str(), Clang.c_str(), "-g", "-O0", "-c", "-emit-llvm", source.c_str(), "-o",
+           bitcode.c_str(), static_cast<char*>(NULL));
+    _exit(127);
+  }
+  int status;
+  return pid > 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status) &&
+         WEXITSTATUS(status) == 0;
+}
+
+static bool IsBitcode(const string& path) {
+  return path.size() >= 3 && path.compare(path.size() - 3, 3, ".bc") == 0;
+}
+
+static Module* Load(const string& path, string* error /* out */) {
+  string bitcode = path;
+  if (!IsBitcode(path)) {
+    char name[] = "/tmp/boadXXXXXX";
+    int fd = mkstemp(name);
+    if (fd < 0) {
+      *error = "can't create a temporary file";
+      return NULL;
+    }
+    close(fd);
+    bitcode = name;
+    if (!Compile(path, bitcode)) {
+      unlink(name);
+      *error = "can't compile " + path;
+      return NULL;
+    }
+  }
+  OwningPtr<MemoryBuffer> buffer;
+  Module* module = NULL;
+  if (error_code ec = MemoryBuffer::getFile(bitcode, buffer)) {
+    *error = "can't read " + path + " - " + ec.message();
+  } else {
+    module = ParseBitcodeFile(buffer.get(), getGlobalContext(), error);
+  }
+  if (bitcode != path) {
+    unlink(bitcode.c_str());
+  }
+  return module;
+}
+
+static void Analyze(Analyzer* analyzer, const vector<string>& paths, ostream& out) {
+  Module* module = NULL;
+  string error;
+  for (size_t i = 0; i < paths.size() && error.empty(); ++i) {
+    Module* next = Load(paths[i], &error);
+    if (next == NULL) {
+      break;
+    }
+    if (module == NULL) {
+      module = next;
+    } else {
+      Linker::LinkModules(module, next, &error);
+      delete next;
+    }
+  }
+  if (!error.empty() || module == NULL) {
+    out << "error: " << (error.empty() ? string("no files") : error) << endl;
+    delete module;
+    return;
+  }
+
+  // The same as opt -mem2reg in the boa script.
+  PassManager passes;
+  passes.add(createPromoteMemoryToRegisterPass());
+  passes.run(*module);
+
+  analyzer->Generate(*module);
+  delete module;
+  analyzer->Report(out, false);
+}
+
+static int Serve() {
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0 || !Connect(listener, true)) {
+    cerr << "can't listen on " << Socket << " - " << strerror(errno) << endl;
+    return 1;
+  }
+  // A client which goes away must not kill the daemon.
+  signal(SIGPIPE, SIG_IGN);
+  Analyzer analyzer(true);
+  while (true) {
+    int client = accept(listener, NULL, NULL);
+    if (client < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      cerr << "accept failed - " << strerror(errno) << endl;
+      break;
+    }
+    vector<string> paths;
+    ReadRequest(client, &paths);
+    if (paths.size() == 1 && paths[0] == QUIT) {
+      close(client);
+      break;
+    }
+    LOG_INFO << "Request of " << paths.size() << " files" << endl;
+    stringstream out;
+    Analyze(&analyzer, paths, out);
+    WriteAll(client, out.str());
+    close(client);
+  }
+  close(listener);
+  unlink(Socket.c_str());
+  Analyzer::WriteProfile();
+  return 0;
+}
+
+static int Send() {
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0 || !Connect(fd, false)) {
+    cerr << "can't connect to " << Socket << " - " << strerror(errno) << endl;
+    return 1;
+  }
+  // The daemon doesn't share our working directory.
+  stringstream request;
+  if (Quit) {
+    request << QUIT << endl;
+  }
+  for (size_t i = 0; i < Files.size() && !Quit; ++i) {
+    char path[PATH_MAX];
+    request << (realpath(Files[i].c_str(), path) ? path : Files[i].c_str()) << endl;
+  }
+  request << endl;
+  if (!WriteAll(fd, request.str())) {
+    cerr << "can't send the request - " << strerror(errno) << endl;
+    return 1;
+  }
+  char buffer[4096];
+  ssize_t n;
+  while ((n = read(fd, buffer, sizeof(buffer))) > 0 || (n < 0 && errno == EINTR)) {
+    if (n > 0) {
+      cerr.write(buffer, n);
+    }
+  }
+  close(fd);
+  return 0;
+}
+
+}  // namespace boa
+
+int main(int argc, char** argv) {
+  cl::ParseCommandLineOptions(argc, argv, "boa daemon - buffer overrun analyzer\n");
+  return Client ? boa::Send() : boa::Serve();
+}
@@ -1,5 +1,7 @@
 #include "log.h"
 
+#include <pthread.h>
+
 using std::ostream;
 
 namespace boa {
@@ -10,13 +12,45 @@ namespace log {
   } devNull;
 
   ostream *os_ = &devNull;
+  int level_ = -1;
+
+  static pthread_key_t threadStream;
+  static pthread_once_t threadStreamOnce = PTHREAD_ONCE_INIT;
 
-  void set(ostream &os) {
+  static void createThreadStream() {
+    pthread_key_create(&threadStream, NULL);
+  }
+
+  void set(ostream &os, Level level) {
     os_=&os;
+    level_ = level;
+  }
+
+  void reset() {
+    os_ = &devNull;
+    level_ = -1;
+  }
+
+  bool parseLevel(const string &name, Level *level) {
+    static const char* names[] = { "error", "info", "debug", "trace" };
+    for (int i = Error; i <= Trace; ++i) {
+      if (name == names[i]) {
+        *level = static_cast<Level>(i);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void setThreadStream(ostream *os) {
+    pthread_once(&threadStreamOnce, &createThreadStream);
+    pthread_setspecific(threadStream, os);
   }
 
   ostream &os() {
-    return *os_;
+    pthread_once(&threadStreamOnce, &createThreadStream);
+    ostream *threadOs = static_cast<ostream*>(pthread_getspecific(threadStream));
+    return threadOs ? *threadOs : *os_;
   }
 }
 
@@ -5,7 +5,6 @@
 #include <iomanip>
 #include <map>
 #include <string>
-#include <time.h>
 
 using std::endl;
 using std::ostream;
@@ -16,25 +15,66 @@ using std::string;
 namespace boa {
 
 namespace log {
-  extern void set(ostream &os);
+  /**
+    Log levels, from the most important to the most verbose.
+  */
+  enum Level { Error = 0, Info, Debug, Trace };
+
+  /**
+    Set the log output stream, and the most verbose level that will be written to it.
+  */
+  extern void set(ostream &os, Level level = Trace);
+
+  /**
+    Disable the log.
+  */
+  extern void reset();
+
+  /**
+    Parse a level name ("error", "info", "debug" or "trace"). Return false if the name is unknown.
+  */
+  extern bool parseLevel(const string &name, Level *level /* out */);
+
+  /**
+    Redirect the log of the calling thread to os, or back to the shared log stream if os is NULL.
+    Used by worker threads to buffer their log output.
+  */
+  extern void setThreadStream(ostream *os);
+
   extern ostream& os();
-  static map<string, long> profTime;
+
+  // The most verbose level currently written, -1 when there is no log at all.
+  extern int level_;
+
+  inline bool enabled(Level level) {
+    return level <= level_;
+  }
 }
 
 }  // namespace boa
 
-#define LOG log::os() << std::setiosflags(std::ios::left) << setw(30) << __FILE__ << ":" << setw(4) << __LINE__ << std::resetiosflags(std::ios::left) << "  "
+/**
+  The most verbose level compiled into boa. Log statements above this level are removed by the
+  compiler, e.g. build with -DBOA_MAX_LOG_LEVEL=2 to strip trace logging entirely.
+*/
+#ifndef BOA_MAX_LOG_LEVEL
+#define BOA_MAX_LOG_LEVEL 3
+#endif
 
 /**
  * Usage:
  *
- *   SET_PROF("any string");
- *   [...]
- *   PROF("any string") << "Optional comment" << endl;
+ *   LOG_INFO << "Solving " << n << " constraints" << endl;
  *
- * You can then run using `prof` instead of `boa` to see the results.
+ * When the level is disabled the cost is a single branch, the streamed operands are not evaluated.
  */
-#define SET_PROF(key) log::profTime[key] = clock()
-#define PROF(key) log::os() << "PROF\t" << setw(30) << (1000 * (clock() - log::profTime[key])) / CLOCKS_PER_SEC << "\t" << __PRETTY_FUNCTION__ << "\t"
+#define LOG_AT(level) \
+  if (((level) > BOA_MAX_LOG_LEVEL) || !log::enabled(level)) ; else \
+    log::os() << std::setiosflags(std::ios::left) << setw(30) << __FILE__ << ":" << setw(4) << __LINE__ << std::resetiosflags(std::ios::left) << "  "
+
+#define LOG_ERROR LOG_AT(log::Error)
+#define LOG_INFO  LOG_AT(log::Info)
+#define LOG_DEBUG LOG_AT(log::Debug)
+#define LOG_TRACE LOG_AT(log::Trace)
 
 #endif /* __BOA_LOG_H */
@@ -0,0 +1,141 @@
+// build/boa - boa without opt.
+//
+// The boa script runs the analysis as an opt pass, which parses the whole module before the pass
+// sees it. This executable reads the bitcode itself -
+//
+//   build/boa -blame file.bc other.bc
+//   clang -g -O0 -c -emit-llvm file.c -o /dev/stdout | build/boa -
+//
+// Bitcode files are memory mapped and loaded lazily, the bodies of the functions are parsed one
+// at a time and promoted to registers like opt -mem2reg does. Every body is parsed - bitcode has
+// no summary of a function to decide on without it - but the bodies of functions which can't
+// matter to any buffer (see ConstraintGenerator::MayTouchBuffers) are dropped right after, and
+// never generated. The bodies of the analyzed functions are kept until all of them were
+// generated, the generator refers to their instructions, and the module is deleted before solving.
+//
+// Every file is analyzed as a separate module, link them first (llvm-link, or boa -project) to
+// analyze them together.
+
+#include "llvm/LLVMContext.h"
+#include "llvm/Module.h"
+#include "llvm/PassManager.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/system_error.h"
+#include "llvm/Transforms/Scalar.h"
+
+#include <unistd.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Analyzer.h"
+#include "ConstraintGenerator.h"
+#include "Profiler.h"
+#include "log.h"
+
+using std::cerr;
+using std::endl;
+using std::string;
+using std::vector;
+
+using namespace llvm;
+
+static cl::opt<bool> NoMem2Reg("nomem2reg", cl::desc("Don't promote memory to registers"));
+static cl::list<string> Files(cl::Positional, cl::desc("<bitcode files, - for stdin>"),
+                              cl::OneOrMore);
+
+namespace boa {
+
+static Module* LoadLazily(const string& path) {
+  OwningPtr<MemoryBuffer> buffer;
+  if (error_code ec = MemoryBuffer::getFileOrSTDIN(path, buffer)) {
+    cerr << "can't read " << path << " - " << ec.message() << endl;
+    return NULL;
+  }
+  string error;
+  Module* module = getLazyBitcodeModule(buffer.get(), getGlobalContext(), &error);
+  if (module == NULL) {
+    cerr << "can't load " << path << " - " << error << endl;
+    return NULL;
+  }
+  // Owned by the module from now on.
+  buffer.take();
+  return module;
+}
+
+/**
+  Analyze module and delete it.
+*/
+static bool Analyze(Analyzer* analyzer, Module* module) {
+  // All the bodies are read before any function is visited, so every call finds its callee
+  // materialized (or dropped) as it would be in a fully parsed module.
+  vector<const Function*> functions;
+  string error;
+  {
+    ProfileScope scope("materialize");
+    FunctionPassManager passes(module);
+    if (!NoMem2Reg) {
+      passes.add(createPromoteMemoryToRegisterPass());
+    }
+    passes.doInitialization();
+    for (Module::iterator it = module->begin(); it != module->end() && error.empty(); ++it) {
+      Function* F = it;
+      if (F->isMaterializable() && F->Materialize(&error)) {
+        cerr << "can't read the body of " << F->getNameStr() << " - " << error << endl;
+        continue;
+      }
+      if (F->isDeclaration()) {
+        continue;
+      }
+      // With "skipped functions", the share of the parsed bodies which were dropped.
+      Profiler::Count("parsed functions", 1);
+      passes.run(*F);
+      if (!ConstraintGenerator::MayTouchBuffers(F)) {
+        LOG_DEBUG << "Skipping " << F->getNameStr() << endl;
+        Profiler::Count("skipped functions", 1);
+        F->Dematerialize();
+        continue;
+      }
+      functions.push_back(F);
+    }
+    passes.doFinalization();
+  }
+  if (!error.empty()) {
+    delete module;
+    return false;
+  }
+
+  analyzer->BeginModule(*module);
+  for (size_t i = 0; i < functions.size(); ++i) {
+    analyzer->VisitFunction(functions[i]);
+  }
+  analyzer->EndModule();
+  // Frees the bitcode and the bodies before solving.
+  delete module;
+  // use colors only if stderror is a tty
+  analyzer->Report(cerr, isatty(2));
+  return true;
+}
+
+}  // namespace boa
+
+int main(int argc, char** argv) {
+  cl::ParseCommandLineOptions(argc, argv, "boa - buffer overrun analyzer\n");
+  boa::Analyzer analyzer;
+  int result = 0;
+  for (size_t i = 0; i < Files.size(); ++i) {
+    if (Files.size() > 1) {
+      cerr << Files[i] << endl;
+    }
+    Module* module = boa::LoadLazily(Files[i]);
+    if (module == NULL || !boa::Analyze(&analyzer, module)) {
+      result = 1;
+    }
+  }
+  boa::Analyzer::WriteProfile();
+  return result;
+}
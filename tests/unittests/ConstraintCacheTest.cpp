@@ -0,0 +1,91 @@
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "ConstraintCache.h"
+
+using std::string;
+
+namespace boa {
+
+TEST(ConstraintCacheTest, RoundTrip) {
+  ConstraintCache::Writer writer;
+  writer.PutInt(7);
+  writer.PutInt(0xdeadbeef);
+  writer.PutDouble(-2.5);
+  writer.PutString("strcpy call");
+  writer.PutString("");
+
+  ConstraintCache::Reader reader(writer.Data());
+  uint32_t i;
+  double d;
+  string s;
+  ASSERT_TRUE(reader.GetInt(&i));
+  ASSERT_EQ(7u, i);
+  ASSERT_TRUE(reader.GetInt(&i));
+  ASSERT_EQ(0xdeadbeef, i);
+  ASSERT_TRUE(reader.GetDouble(&d));
+  ASSERT_DOUBLE_EQ(-2.5, d);
+  ASSERT_TRUE(reader.GetString(&s));
+  ASSERT_EQ("strcpy call", s);
+  ASSERT_TRUE(reader.GetString(&s));
+  ASSERT_EQ("", s);
+  ASSERT_TRUE(reader.AtEnd());
+  ASSERT_TRUE(reader.Ok());
+}
+
+TEST(ConstraintCacheTest, Truncated) {
+  ConstraintCache::Writer writer;
+  writer.PutString("a long string");
+  string data = writer.Data().substr(0, 6);
+
+  ConstraintCache::Reader reader(data);
+  string s;
+  ASSERT_FALSE(reader.GetString(&s));
+  ASSERT_FALSE(reader.Ok());
+  // Failures are sticky.
+  uint32_t i;
+  ASSERT_FALSE(reader.GetInt(&i));
+}
+
+TEST(ConstraintCacheTest, StoreLoad) {
+  char dir[] = "/tmp/boacacheXXXXXX";
+  ASSERT_TRUE(mkdtemp(dir) != NULL);
+  {
+    ConstraintCache cache(dir);
+    string data;
+    ASSERT_FALSE(cache.Load(1, &data));
+
+    string record("record\0with a null", 18);
+    cache.Store(1, record);
+    cache.Store(2, "other");
+    ASSERT_TRUE(cache.Load(1, &data));
+    ASSERT_EQ(record, data);
+    ASSERT_TRUE(cache.Load(2, &data));
+    ASSERT_EQ("other", data);
+
+    // A second cache on the same directory sees the entries.
+    ConstraintCache other(dir);
+    ASSERT_TRUE(other.Load(1, &data));
+    ASSERT_EQ(record, data);
+  }
+  string cleanup = string("rm -rf ") + dir;
+  ASSERT_EQ(0, system(cleanup.c_str()));
+}
+
+TEST(ConstraintCacheTest, Memory) {
+  ConstraintCache cache("");
+  string data;
+  ASSERT_FALSE(cache.Load(3, &data));
+  cache.Store(3, "in memory");
+  ASSERT_TRUE(cache.Load(3, &data));
+  ASSERT_EQ("in memory", data);
+  // Memory caches are not shared.
+  ConstraintCache other("");
+  ASSERT_FALSE(other.Load(3, &data));
+}
+
+}  // namespace boa
@@ -2,11 +2,17 @@
 
 #include "ConstraintGenerator.h"
 
+#include "llvm/Constants.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/LLVMContext.h"
+
 #include <set>
 #include <string>
+#include <vector>
 
 using std::set;
 using std::string;
+using std::vector;
 
 namespace boa {
 
@@ -28,7 +34,7 @@ class MockConstraintProblem : public ConstraintProblem {
 
   virtual void AddConstraint(const Constraint& constraint) {
     EXPECT_DOUBLE_EQ(left_, constraint.left_);
-    EXPECT_EQ(blame_ + " [" + location_ + "]", constraint.blame_);
+    EXPECT_EQ(blame_ + " [" + location_ + "]", constraint.blame_.ToString());
     EXPECT_EQ(type_, constraint.type_);
   }
 };
@@ -72,13 +78,60 @@ TEST_F(ConstraintGeneratorTest, UnsafeFunctionTest) {
 TEST_F(ConstraintGeneratorTest, GenerateConstraintMax) {
   string s = "_Max";
   cp->SetExpectedConstraintParams(10.0 - 12.7, blame+s, location+s, Constraint::NORMAL);
-  cg->GenerateConstraint(10.0, 12.7, VarLiteral::MAX, blame+s, location+s, Constraint::NORMAL);
+  cg->GenerateConstraint(10.0, 12.7, VarLiteral::MAX, BlameMessage(blame+s),
+                         LocationTable::FromText(location+s), Constraint::NORMAL);
 }
 
 TEST_F(ConstraintGeneratorTest, GenerateConstraintMin) {
   string s = "_Min";
   cp->SetExpectedConstraintParams(34.2 - 99.0, blame+s, location+s, Constraint::STRUCTURAL);
-  cg->GenerateConstraint(99.0, 34.2, VarLiteral::MIN, blame+s, location+s, Constraint::STRUCTURAL);
+  cg->GenerateConstraint(99.0, 34.2, VarLiteral::MIN, BlameMessage(blame+s),
+                         LocationTable::FromText(location+s), Constraint::STRUCTURAL);
+}
+
+TEST_F(ConstraintGeneratorTest, MayTouchBuffers) {
+  LLVMContext& context = getGlobalContext();
+  Module module("MayTouchBuffers", context);
+  const Type* voidType = Type::getVoidTy(context);
+  const Type* i32 = Type::getInt32Ty(context);
+  vector<const Type*> noParams, pointerParam(1, Type::getInt8PtrTy(context));
+  const FunctionType* voidFunction = FunctionType::get(voidType, noParams, false);
+
+  // void arithmetic() { 1 + 2; }
+  Function* arithmetic = Function::Create(voidFunction, GlobalValue::ExternalLinkage,
+                                          "arithmetic", &module);
+  BasicBlock* entry = BasicBlock::Create(context, "entry", arithmetic);
+  BinaryOperator::CreateAdd(ConstantInt::get(i32, 1), ConstantInt::get(i32, 2), "sum", entry);
+  ReturnInst::Create(context, entry);
+  ASSERT_FALSE(ConstraintGenerator::MayTouchBuffers(arithmetic));
+
+  // int result() { return 1; }
+  Function* result = Function::Create(FunctionType::get(i32, noParams, false),
+                                      GlobalValue::ExternalLinkage, "result", &module);
+  ReturnInst::Create(context, ConstantInt::get(i32, 1), BasicBlock::Create(context, "", result));
+  ASSERT_TRUE(ConstraintGenerator::MayTouchBuffers(result));
+
+  // void parameter(char* p) {}
+  Function* parameter = Function::Create(FunctionType::get(voidType, pointerParam, false),
+                                         GlobalValue::ExternalLinkage, "parameter", &module);
+  ReturnInst::Create(context, BasicBlock::Create(context, "", parameter));
+  ASSERT_TRUE(ConstraintGenerator::MayTouchBuffers(parameter));
+
+  // void local() { char c; }
+  Function* local = Function::Create(voidFunction, GlobalValue::ExternalLinkage, "local",
+                                     &module);
+  entry = BasicBlock::Create(context, "", local);
+  new AllocaInst(Type::getInt8Ty(context), "c", entry);
+  ReturnInst::Create(context, entry);
+  ASSERT_TRUE(ConstraintGenerator::MayTouchBuffers(local));
+
+  // void caller() { arithmetic(); }
+  Function* caller = Function::Create(voidFunction, GlobalValue::ExternalLinkage, "caller",
+                                      &module);
+  entry = BasicBlock::Create(context, "", caller);
+  CallInst::Create(arithmetic, "", entry);
+  ReturnInst::Create(context, entry);
+  ASSERT_TRUE(ConstraintGenerator::MayTouchBuffers(caller));
 }
 
 }  // namespace boa
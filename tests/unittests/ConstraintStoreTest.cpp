@@ -0,0 +1,101 @@
+#include "gtest/gtest.h"
+
+#include "Constraint.h"
+#include "ConstraintStore.h"
+#include "LocationTable.h"
+#include "VarTable.h"
+
+#include <vector>
+
+using std::vector;
+
+namespace boa {
+
+class ConstraintStoreTest : public ::testing::Test {
+ protected:
+  int node;
+  VarId x, y;
+
+  // Runs before each test.
+  void SetUp() {
+    VarTable::Clear();
+    x = VarTable::Intern(&node, false, VarLiteral::USED, VarLiteral::MAX);
+    y = VarTable::Intern(&node, false, VarLiteral::ALLOC, VarLiteral::MIN);
+  }
+};
+
+TEST_F(ConstraintStoreTest, RowsAreContiguous) {
+  ConstraintStore store;
+  Constraint::Expression xPlusOne(x);
+  xPlusOne.add(1.0);
+  Constraint c1(y, xPlusOne, VarLiteral::MAX);
+  c1.SetBlame(BlameMessage("first"), LocationTable::FromText("here"), Constraint::STRUCTURAL);
+  Constraint c2(x, 5.0, VarLiteral::MIN);
+  c2.SetBlame(BlameMessage("second"), LocationTable::FromText("there"), Constraint::NORMAL);
+  store.Add(c1);
+  store.Add(c2);
+
+  ASSERT_EQ(2u, store.Size());
+  ASSERT_EQ(3u, store.NonZeros());
+  ASSERT_EQ(0u, store.RowBegin(0));
+  ASSERT_EQ(2u, store.RowEnd(0));
+  ASSERT_EQ(2u, store.RowBegin(1));
+  ASSERT_EQ(3u, store.RowEnd(1));
+
+  // y >= x + 1 is stored as -1 >= x - y
+  ASSERT_DOUBLE_EQ(-1.0, store.Left(0));
+  ASSERT_EQ(x, store.Var(0));
+  ASSERT_DOUBLE_EQ(1.0, store.Coef(0));
+  ASSERT_EQ(y, store.Var(1));
+  ASSERT_DOUBLE_EQ(-1.0, store.Coef(1));
+
+  // x <= 5 is stored as 5 >= x
+  ASSERT_DOUBLE_EQ(5.0, store.Left(1));
+  ASSERT_EQ(x, store.Var(2));
+  ASSERT_DOUBLE_EQ(1.0, store.Coef(2));
+
+  ASSERT_EQ(Constraint::STRUCTURAL, store.GetType(0));
+  ASSERT_EQ(Constraint::NORMAL, store.GetType(1));
+
+  ASSERT_EQ("first [here]", store.Blame(0).ToString());
+  ASSERT_EQ("second [there]", store.Blame(1).ToString());
+}
+
+TEST_F(ConstraintStoreTest, ZerosAreNotStored) {
+  ConstraintStore store;
+  Constraint c(x, x, VarLiteral::MAX);
+  c.SetBlame(BlameMessage("zero"), LocationTable::FromText("here"));
+  store.Add(c);
+  ASSERT_EQ(1u, store.Size());
+  ASSERT_EQ(0u, store.NonZeros());
+
+  vector<bool> used(VarTable::Size(), false);
+  store.GetVars(used);
+  ASSERT_FALSE(used[x.Index()]);
+  ASSERT_FALSE(used[y.Index()]);
+}
+
+TEST_F(ConstraintStoreTest, UnboundedAreNotRows) {
+  ConstraintStore store;
+  store.AddUnbounded(x, BlameInfo(BlameMessage("unknown"), LocationTable::FromText("here")));
+  ASSERT_TRUE(store.Empty());
+  ASSERT_EQ(0u, store.NonZeros());
+  ASSERT_EQ(1u, store.UnboundedSize());
+  ASSERT_EQ(x, store.UnboundedVar(0));
+  ASSERT_EQ("unknown [here]", store.UnboundedBlame(0).ToString());
+}
+
+TEST_F(ConstraintStoreTest, Clear) {
+  ConstraintStore store;
+  Constraint c(x, y, VarLiteral::MAX);
+  c.SetBlame(BlameMessage("blame"), LocationTable::FromText("here"));
+  store.Add(c);
+  store.AddUnbounded(y, BlameInfo(BlameMessage("unknown"), LocationTable::FromText("here")));
+  store.Clear();
+  ASSERT_TRUE(store.Empty());
+  ASSERT_EQ(0u, store.NonZeros());
+  ASSERT_EQ(0u, store.RowBegin(0));
+  ASSERT_EQ(0u, store.UnboundedSize());
+}
+
+}  // namespace boa
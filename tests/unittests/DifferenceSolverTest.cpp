@@ -0,0 +1,75 @@
+#include "gtest/gtest.h"
+
+#include "DifferenceSolver.h"
+
+namespace boa {
+
+TEST(DifferenceSolverTest, Chain) {
+  // x >= 3, y >= x + 2, z >= y - 1
+  DifferenceSolver solver(3);
+  solver.AddLowerBound(0, 3);
+  solver.AddDifference(0, 1, -2);
+  solver.AddDifference(1, 2, 1);
+  ASSERT_TRUE(solver.Solve());
+  ASSERT_EQ(3, solver.Value(0));
+  ASSERT_EQ(5, solver.Value(1));
+  ASSERT_EQ(4, solver.Value(2));
+}
+
+TEST(DifferenceSolverTest, Unbounded) {
+  // y >= x, x has no lower bound
+  DifferenceSolver solver(3);
+  solver.AddDifference(0, 1, 0);
+  solver.AddLowerBound(2, 7);
+  ASSERT_TRUE(solver.Solve());
+  ASSERT_EQ(DifferenceSolver::MinusInfinity(), solver.Value(0));
+  ASSERT_EQ(DifferenceSolver::MinusInfinity(), solver.Value(1));
+  ASSERT_EQ(7, solver.Value(2));
+}
+
+TEST(DifferenceSolverTest, ZeroCycle) {
+  // x == y (x - y <= 0, y - x <= 0), x >= 1, y >= 4
+  DifferenceSolver solver(2);
+  solver.AddDifference(0, 1, 0);
+  solver.AddDifference(1, 0, 0);
+  solver.AddLowerBound(0, 1);
+  solver.AddLowerBound(1, 4);
+  ASSERT_TRUE(solver.Solve());
+  ASSERT_EQ(4, solver.Value(0));
+  ASSERT_EQ(4, solver.Value(1));
+}
+
+TEST(DifferenceSolverTest, PositiveCycle) {
+  // y >= x + 1, x >= y
+  DifferenceSolver solver(2);
+  solver.AddDifference(0, 1, -1);
+  solver.AddDifference(1, 0, 0);
+  ASSERT_FALSE(solver.Solve());
+}
+
+TEST(DifferenceSolverTest, PositiveSelfLoop) {
+  // x >= x + 1
+  DifferenceSolver solver(1);
+  solver.AddDifference(0, 0, -1);
+  ASSERT_FALSE(solver.Solve());
+}
+
+TEST(DifferenceSolverTest, UpperBound) {
+  // x >= 2, y >= x + 3, y <= 4
+  DifferenceSolver solver(2);
+  solver.AddLowerBound(0, 2);
+  solver.AddDifference(0, 1, -3);
+  solver.AddUpperBound(1, 4);
+  ASSERT_FALSE(solver.Solve());
+  solver.AddUpperBound(1, 2);
+  ASSERT_FALSE(solver.Solve());
+
+  DifferenceSolver feasable(2);
+  feasable.AddLowerBound(0, 2);
+  feasable.AddDifference(0, 1, -3);
+  feasable.AddUpperBound(1, 5);
+  ASSERT_TRUE(feasable.Solve());
+  ASSERT_EQ(5, feasable.Value(1));
+}
+
+}  // namespace boa
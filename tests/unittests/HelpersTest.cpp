@@ -8,7 +8,10 @@
 using std::set;
 using std::string;
 
+using boa::Helpers::Hash;
+using boa::Helpers::HashBytes;
 using boa::Helpers::IsPrefix;
+using boa::Helpers::JsonString;
 using boa::Helpers::ReplaceInString;
 using boa::Helpers::SplitString;
 
@@ -43,3 +46,17 @@ TEST(HelpersTest, SplitStringTest) {
   ASSERT_EQ(1, split.count("b"));
   ASSERT_EQ(1, split.count("c"));
 }
+
+TEST(HelpersTest, HashTest) {
+  ASSERT_EQ(0xcbf29ce484222325ULL, Hash(""));
+  ASSERT_EQ(0xaf63dc4c8601ec8cULL, Hash("a"));
+  ASSERT_EQ(Hash("abcd"), Hash("cd", Hash("ab")));
+  ASSERT_NE(Hash("ab"), Hash("ba"));
+  ASSERT_EQ(Hash("abc"), HashBytes("abcd", 3));
+}
+
+TEST(HelpersTest, JsonStringTest) {
+  ASSERT_EQ("\"\"", JsonString(""));
+  ASSERT_EQ("\"buf [a.c:3]\"", JsonString("buf [a.c:3]"));
+  ASSERT_EQ("\"say \\\"hi\\\" \\\\ \\n\\u0009\"", JsonString("say \"hi\" \\ \n\t"));
+}
@@ -0,0 +1,106 @@
+#include "gtest/gtest.h"
+
+#include "LinearProblem.h"
+
+#include <algorithm>
+
+using std::sort;
+
+namespace boa {
+
+class LinearProblemTest : public ::testing::Test {
+ protected:
+  LinearProblem lp;
+
+  // Add the soft row coef * x_col <= ub.
+  void AddRow(int col, double coef, double ub) {
+    int row = glp_add_rows(lp.lp_, 1);
+    int indices[] = { 0, col };
+    double values[] = { 0.0, coef };
+    glp_set_mat_row(lp.lp_, row, 1, indices, values);
+    glp_set_row_bnds(lp.lp_, row, GLP_UP, 0.0, ub);
+    lp.rowOrigin_.push_back(row);
+    ++lp.realRows_;
+  }
+
+  // Two disjoint conflicts - rows 1, 2 (x1 >= 5, x1 <= 3) and rows 3, 4 (x2 >= 10, x2 <= 1), and
+  // the feasable row 5 (x3 <= 7).
+  virtual void SetUp() {
+    LinearProblem::SetBatchRepair(true);
+    glp_set_obj_dir(lp.lp_, GLP_MAX);
+    glp_add_cols(lp.lp_, 3);
+    for (int i = 1; i <= 3; ++i) {
+      glp_set_col_bnds(lp.lp_, i, GLP_FR, 0.0, 0.0);
+    }
+    lp.structuralRows_ = lp.aliasingRows_ = lp.realRows_ = 0;
+    lp.rowOrigin_.assign(1, 0);
+    AddRow(1, -1.0, -5.0);
+    AddRow(1, 1.0, 3.0);
+    AddRow(2, -1.0, -10.0);
+    AddRow(2, 1.0, 1.0);
+    AddRow(3, 1.0, 7.0);
+
+    glp_smcp params;
+    glp_init_smcp(&params);
+    params.msg_lev = GLP_MSG_OFF;
+    lp.SetParams(params);
+  }
+
+  virtual void TearDown() {
+    LinearProblem::SetBatchRepair(true);
+  }
+
+  static vector<int> Sorted(vector<int> rows) {
+    sort(rows.begin(), rows.end());
+    return rows;
+  }
+};
+
+TEST_F(LinearProblemTest, FindIISSingle) {
+  vector<int> iis = Sorted(lp.FindIIS());
+  ASSERT_EQ(2U, iis.size());
+  if (iis[0] == 1) {
+    ASSERT_EQ(2, iis[1]);
+  } else {
+    ASSERT_EQ(3, iis[0]);
+    ASSERT_EQ(4, iis[1]);
+  }
+}
+
+TEST_F(LinearProblemTest, FindIISDisjoint) {
+  vector<int> iis = Sorted(lp.FindIIS(true));
+  ASSERT_EQ(4U, iis.size());
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_EQ(i + 1, iis[i]);
+  }
+}
+
+TEST_F(LinearProblemTest, FindIISFeasable) {
+  lp.RemoveRow(1);
+  lp.RemoveRow(3);
+  ASSERT_TRUE(lp.FindIIS(true).empty());
+}
+
+TEST_F(LinearProblemTest, RemoveInfeasableBatch) {
+  ASSERT_EQ(GLP_NOFEAS, lp.Solve());
+  ASSERT_EQ(4, lp.RemoveInfeasable());
+  ASSERT_EQ(GLP_OPT, lp.SolveDual());
+  ASSERT_TRUE(lp.IsUnbounded(1));
+  ASSERT_TRUE(lp.IsUnbounded(2));
+  ASSERT_FALSE(lp.IsUnbounded(3));
+}
+
+TEST_F(LinearProblemTest, RemoveInfeasableOneByOne) {
+  LinearProblem::SetBatchRepair(false);
+  ASSERT_EQ(GLP_NOFEAS, lp.Solve());
+  ASSERT_EQ(2, lp.RemoveInfeasable());
+  int status = lp.SolveDual();
+  ASSERT_TRUE((status == GLP_INFEAS) || (status == GLP_NOFEAS));
+  ASSERT_EQ(2, lp.RemoveInfeasable());
+  ASSERT_EQ(GLP_OPT, lp.SolveDual());
+  ASSERT_TRUE(lp.IsUnbounded(1));
+  ASSERT_TRUE(lp.IsUnbounded(2));
+  ASSERT_FALSE(lp.IsUnbounded(3));
+}
+
+}  // namespace boa
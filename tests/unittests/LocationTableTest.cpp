@@ -0,0 +1,52 @@
+#include "gtest/gtest.h"
+
+#include "BlameInfo.h"
+#include "LocationTable.h"
+
+namespace boa {
+
+class LocationTableTest : public ::testing::Test {
+ protected:
+  // Runs before each test.
+  void SetUp() {
+    LocationTable::Clear();
+  }
+};
+
+TEST_F(LocationTableTest, FileLine) {
+  Location a = LocationTable::FromFileLine("a.c", 12);
+  ASSERT_EQ("a.c:12", LocationTable::ToString(a));
+  ASSERT_TRUE(a == LocationTable::FromFileLine("a.c", 12));
+  ASSERT_FALSE(a == LocationTable::FromFileLine("a.c", 13));
+  ASSERT_FALSE(a == LocationTable::FromFileLine("b.c", 12));
+}
+
+TEST_F(LocationTableTest, Text) {
+  Location literal = LocationTable::FromText("(literal)");
+  ASSERT_EQ("(literal)", LocationTable::ToString(literal));
+  ASSERT_TRUE(Location() == LocationTable::FromText(""));
+  ASSERT_EQ("", LocationTable::ToString(Location()));
+}
+
+TEST_F(LocationTableTest, NodeCache) {
+  int node, other;
+  Location location;
+  ASSERT_FALSE(LocationTable::Lookup(&node, &location));
+  LocationTable::Cache(&node, LocationTable::FromFileLine("a.c", 3));
+  ASSERT_TRUE(LocationTable::Lookup(&node, &location));
+  ASSERT_EQ("a.c:3", LocationTable::ToString(location));
+  ASSERT_FALSE(LocationTable::Lookup(&other, &location));
+}
+
+TEST_F(LocationTableTest, BlameText) {
+  BlameInfo blame(BlameMessage("strcpy call"), LocationTable::FromFileLine("a.c", 7));
+  ASSERT_EQ("strcpy call [a.c:7]", blame.ToString());
+  ASSERT_EQ("[]", BlameInfo().ToString());
+
+  BlameMessage call(BlameMessage("unknown function call"), "foo");
+  ASSERT_EQ("unknown function call foo", call.ToString());
+  ASSERT_TRUE(call == BlameMessage(BlameMessage("unknown function call"), "foo"));
+  ASSERT_FALSE(call == BlameMessage("unknown function call foo"));
+}
+
+}  // namespace boa
@@ -0,0 +1,115 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <string>
+
+#include "ModelTable.h"
+
+using std::string;
+using std::stringstream;
+
+namespace boa {
+
+TEST(ModelTableTest, Libc) {
+  const ModelTable& libc = ModelTable::Libc();
+  const ModelTable::Model* strlen = libc.Find("strlen");
+  ASSERT_TRUE(strlen != NULL);
+  ASSERT_EQ(ModelTable::LENGTH, strlen->kind_);
+  ASSERT_EQ(1U, strlen->argCount_);
+  ASSERT_EQ(0U, strlen->args_[0]);
+  ASSERT_EQ("strlen", strlen->function_);
+
+  const ModelTable::Model* write = libc.Find("write");
+  ASSERT_TRUE(write != NULL);
+  ASSERT_EQ(ModelTable::BOUNDED_WRITE, write->kind_);
+  ASSERT_EQ(1U, write->args_[0]);
+  ASSERT_EQ(2U, write->args_[1]);
+
+  ASSERT_EQ(ModelTable::SAFE, libc.Find("puts")->kind_);
+  ASSERT_EQ(ModelTable::UNSAFE, libc.Find("gets")->kind_);
+  ASSERT_TRUE(libc.Find("strle") == NULL);
+  ASSERT_TRUE(libc.Find("strlen2") == NULL);
+  ASSERT_TRUE(libc.Find("") == NULL);
+}
+
+TEST(ModelTableTest, Pattern) {
+  const ModelTable& libc = ModelTable::Libc();
+  const ModelTable::Model* memcpy = libc.Find("llvm.memcpy.p0i8.p0i8.i64");
+  ASSERT_TRUE(memcpy != NULL);
+  ASSERT_EQ(ModelTable::COPY, memcpy->kind_);
+  ASSERT_EQ("memcpy", memcpy->function_);
+  ASSERT_EQ("memcpy write to destination buffer", memcpy->blames_[0].ToString());
+  ASSERT_EQ("memcpy read from source buffer", memcpy->blames_[1].ToString());
+  ASSERT_EQ("", memcpy->blames_[2].ToString());
+  ASSERT_TRUE(libc.Find("llvm.memcpy.p0i8.p0i8.i32") == memcpy);
+  ASSERT_TRUE(libc.Find("llvm.memcpy") == NULL);
+  ASSERT_TRUE(libc.Find("llvm.memcpyx.p0i8") == NULL);
+  ASSERT_TRUE(libc.Find("memcpy") == NULL);
+}
+
+TEST(ModelTableTest, Fits) {
+  const ModelTable::Model* memcmp = ModelTable::Libc().Find("memcmp");
+  ASSERT_TRUE(memcmp->Fits(3));
+  ASSERT_FALSE(memcmp->Fits(2));
+  // pipe's second argument is the index written, not an argument.
+  ASSERT_TRUE(ModelTable::Libc().Find("pipe")->Fits(1));
+}
+
+TEST(ModelTableTest, Add) {
+  ModelTable models(ModelTable::Libc());
+  string error;
+  ASSERT_TRUE(models.Add("# in house\n"
+                         "xstrdup duplicate 0  # never NULL\n"
+                         "\n"
+                         "strlen safe\n"
+                         "my.copy.* copy 1 2 0\n", "house.models", &error));
+  ASSERT_EQ(ModelTable::Libc().Size() + 2, models.Size());
+  ASSERT_EQ(ModelTable::DUPLICATE, models.Find("xstrdup")->kind_);
+  ASSERT_EQ(ModelTable::SAFE, models.Find("strlen")->kind_);
+  ASSERT_EQ(ModelTable::LENGTH, ModelTable::Libc().Find("strlen")->kind_);
+  const ModelTable::Model* copy = models.Find("my.copy.i8");
+  ASSERT_TRUE(copy != NULL);
+  ASSERT_EQ("my.copy", copy->function_);
+  ASSERT_EQ(1U, copy->args_[0]);
+  ASSERT_EQ(0U, copy->args_[2]);
+  ASSERT_EQ(ModelTable::COPY, models.Find("llvm.memcpy.p0i8.p0i8.i64")->kind_);
+  ASSERT_NE(ModelTable::Libc().Fingerprint(), models.Fingerprint());
+}
+
+TEST(ModelTableTest, Errors) {
+  ModelTable models;
+  string error;
+  ASSERT_FALSE(models.Add("f alloc 0\ng allocate 0\n", "a.models", &error));
+  ASSERT_EQ("a.models:2: unknown model \"allocate\" of g", error);
+  ASSERT_FALSE(models.Add("f alloc -1\n", "a.models", &error));
+  ASSERT_EQ("a.models:1: bad argument \"-1\" of f", error);
+  ASSERT_FALSE(models.Add("f copy 0 1\n", "a.models", &error));
+  ASSERT_EQ("a.models:1: copy takes 3 arguments", error);
+  ASSERT_FALSE(models.Add("f\n", "a.models", &error));
+  ASSERT_FALSE(models.Load("/nonexistent/boa.models", &error));
+  // Nothing of a bad specification is added.
+  ASSERT_EQ(0U, models.Size());
+  ASSERT_TRUE(models.Find("f") == NULL);
+}
+
+TEST(ModelTableTest, PerfectHash) {
+  ModelTable models;
+  stringstream spec;
+  for (int i = 0; i < 500; ++i) {
+    spec << "function" << i << " alloc " << i % 3 << "\n";
+  }
+  string error;
+  ASSERT_TRUE(models.Add(spec.str(), "many.models", &error));
+  ASSERT_EQ(500U, models.Size());
+  for (int i = 0; i < 500; ++i) {
+    stringstream name;
+    name << "function" << i;
+    const ModelTable::Model* model = models.Find(name.str());
+    ASSERT_TRUE(model != NULL);
+    ASSERT_EQ(name.str(), model->function_);
+    ASSERT_EQ(static_cast<unsigned>(i % 3), model->args_[0]);
+  }
+  ASSERT_TRUE(models.Find("function500") == NULL);
+}
+
+}  // namespace boa
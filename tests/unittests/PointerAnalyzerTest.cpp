@@ -0,0 +1,165 @@
+#include "gtest/gtest.h"
+
+#include "Buffer.h"
+#include "PointerAnalyzer.h"
+
+#include <vector>
+
+using std::vector;
+
+namespace boa {
+
+class PointerAnalyzerTest : public ::testing::Test {
+ protected:
+  // Distinct addresses for the llvm nodes.
+  int nodes[12];
+  PointerAnalyzer analyzer;
+  vector<Buffer> result;
+
+  Buffer Node(int i) {
+    return Buffer(&nodes[i]);
+  }
+};
+
+TEST_F(PointerAnalyzerTest, Copy) {
+  analyzer.AddBuffer(Node(0));
+  analyzer.AddBuffer(Node(1));
+  analyzer.AddCopy(Node(0), Node(2));
+  analyzer.AddCopy(Node(2), Node(3));
+  analyzer.AddCopy(Node(1), Node(4));
+  analyzer.Solve();
+
+  analyzer.PointsTo(Node(3), &result);
+  ASSERT_EQ(1u, result.size());
+  ASSERT_FALSE(result[0] < Node(0) || Node(0) < result[0]);
+
+  analyzer.PointsTo(Node(4), &result);
+  ASSERT_EQ(1u, result.size());
+  ASSERT_FALSE(result[0] < Node(1) || Node(1) < result[0]);
+
+  // Nothing was assigned to 5, it may point to any buffer.
+  analyzer.PointsTo(Node(5), &result);
+  ASSERT_EQ(2u, result.size());
+}
+
+TEST_F(PointerAnalyzerTest, LoadStore) {
+  // slot = alloca; *slot = buffer; pp = slot; p = *pp
+  analyzer.AddBuffer(Node(0));
+  analyzer.AddObject(Node(1));
+  analyzer.AddStore(Node(1), Node(0));
+  analyzer.AddCopy(Node(1), Node(2));
+  analyzer.AddLoad(Node(2), Node(3));
+  // an unrelated buffer
+  analyzer.AddBuffer(Node(4));
+  analyzer.Solve();
+
+  analyzer.PointsTo(Node(3), &result);
+  ASSERT_EQ(1u, result.size());
+  ASSERT_FALSE(result[0] < Node(0) || Node(0) < result[0]);
+}
+
+TEST_F(PointerAnalyzerTest, StoreAfterLoad) {
+  // The store is added after the load, through another pointer to the same slot.
+  analyzer.AddObject(Node(1));
+  analyzer.AddLoad(Node(1), Node(3));
+  analyzer.AddCopy(Node(1), Node(2));
+  analyzer.AddStore(Node(2), Node(0));
+  analyzer.AddBuffer(Node(0));
+  analyzer.Solve();
+
+  analyzer.PointsTo(Node(3), &result);
+  ASSERT_EQ(1u, result.size());
+}
+
+TEST_F(PointerAnalyzerTest, Memcpy) {
+  // char *a[1] = {s}, *b[1] = {t}; memcpy(b, a, sizeof(a)); q = b[0]
+  analyzer.AddBuffer(Node(0));
+  analyzer.AddBuffer(Node(1));
+  analyzer.AddBuffer(Node(2));
+  analyzer.AddBuffer(Node(3));
+  analyzer.AddStore(Node(0), Node(2));
+  analyzer.AddStore(Node(1), Node(3));
+  // The copied pointers go through the call's temporary.
+  analyzer.AddLoad(Node(0), Node(4));
+  analyzer.AddStore(Node(1), Node(4));
+  analyzer.AddLoad(Node(1), Node(5));
+  // an unrelated buffer
+  analyzer.AddBuffer(Node(6));
+  analyzer.Solve();
+
+  analyzer.PointsTo(Node(5), &result);
+  ASSERT_EQ(2u, result.size());
+  ASSERT_FALSE(result[0] < Node(2) || Node(2) < result[0]);
+  ASSERT_FALSE(result[1] < Node(3) || Node(3) < result[1]);
+}
+
+TEST_F(PointerAnalyzerTest, Unknown) {
+  analyzer.AddBuffer(Node(0));
+  analyzer.AddBuffer(Node(1));
+  analyzer.AddObject(Node(2));
+  // *slot is passed to an unknown function
+  analyzer.AddEscape(Node(2));
+  analyzer.AddLoad(Node(2), Node(3));
+  analyzer.AddUnknown(Node(4));
+  analyzer.Solve();
+
+  analyzer.PointsTo(Node(3), &result);
+  ASSERT_EQ(2u, result.size());
+  analyzer.PointsTo(Node(4), &result);
+  ASSERT_EQ(2u, result.size());
+}
+
+TEST_F(PointerAnalyzerTest, GlobalInitializer) {
+  // char *tab[2] = {a, b}; char **gp = tab; p = gp (loaded); q = *p
+  analyzer.AddBuffer(Node(0));
+  analyzer.AddBuffer(Node(1));
+  analyzer.AddBuffer(Node(2));
+  analyzer.AddStore(Node(0), Node(1));
+  analyzer.AddStore(Node(0), Node(2));
+  analyzer.AddObject(Node(3));
+  analyzer.AddCopy(Node(0), Node(4));
+  analyzer.AddStore(Node(3), Node(4));
+  analyzer.AddLoad(Node(3), Node(5));
+  analyzer.AddLoad(Node(5), Node(6));
+  // an unrelated buffer
+  analyzer.AddBuffer(Node(7));
+  analyzer.Solve();
+
+  analyzer.PointsTo(Node(5), &result);
+  ASSERT_EQ(1u, result.size());
+  ASSERT_FALSE(result[0] < Node(0) || Node(0) < result[0]);
+  analyzer.PointsTo(Node(6), &result);
+  ASSERT_EQ(2u, result.size());
+}
+
+TEST_F(PointerAnalyzerTest, ExternalParameter) {
+  // main(int argc, char **argv) - argv comes from a caller which is not analyzed.
+  analyzer.AddBuffer(Node(0));
+  analyzer.AddBuffer(Node(1));
+  analyzer.AddUnknown(Node(2));
+  analyzer.AddLoad(Node(2), Node(3));
+  analyzer.Solve();
+
+  analyzer.PointsTo(Node(3), &result);
+  ASSERT_EQ(2u, result.size());
+}
+
+TEST_F(PointerAnalyzerTest, NoBuffer) {
+  // p is loaded from a slot nothing is stored in, q from a slot holding a pointer to a slot.
+  analyzer.AddBuffer(Node(0));
+  analyzer.AddBuffer(Node(1));
+  analyzer.AddObject(Node(2));
+  analyzer.AddLoad(Node(2), Node(3));
+  analyzer.AddObject(Node(4));
+  analyzer.AddObject(Node(5));
+  analyzer.AddStore(Node(4), Node(5));
+  analyzer.AddLoad(Node(4), Node(6));
+  analyzer.Solve();
+
+  analyzer.PointsTo(Node(3), &result);
+  ASSERT_EQ(2u, result.size());
+  analyzer.PointsTo(Node(6), &result);
+  ASSERT_EQ(2u, result.size());
+}
+
+}  // namespace boa
@@ -0,0 +1,65 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <string>
+
+#include "Profiler.h"
+
+using std::string;
+using std::stringstream;
+
+namespace boa {
+
+class ProfilerTest : public ::testing::Test {
+ protected:
+  // Runs before each test.
+  void SetUp() {
+    Profiler::Clear();
+  }
+
+  void TearDown() {
+    Profiler::Clear();
+  }
+
+  static string Json() {
+    stringstream ss;
+    Profiler::WriteJson(ss);
+    return ss.str();
+  }
+};
+
+TEST_F(ProfilerTest, DisabledByDefault) {
+  {
+    ProfileScope scope("phase");
+    Profiler::Count("rows", 3);
+  }
+  ASSERT_EQ("", Json());
+}
+
+TEST_F(ProfilerTest, Nesting) {
+  Profiler::Enable();
+  {
+    ProfileScope outer("outer");
+    {
+      ProfileScope inner("inner");
+      Profiler::Count("rows", 3);
+    }
+    {
+      ProfileScope inner("inner");
+      Profiler::Count("rows", 4);
+    }
+  }
+  string json = Json();
+  size_t outer = json.find("\"name\": \"outer\"");
+  size_t inner = json.find("\"name\": \"inner\"");
+  ASSERT_NE(string::npos, json.find("\"name\": \"boa\""));
+  ASSERT_NE(string::npos, outer);
+  ASSERT_NE(string::npos, inner);
+  ASSERT_LT(outer, inner);
+  // Both calls of inner are accumulated into one node
+  ASSERT_EQ(inner, json.rfind("\"name\": \"inner\""));
+  ASSERT_NE(string::npos, json.find("\"calls\": 2"));
+  ASSERT_NE(string::npos, json.find("\"rows\": 7"));
+}
+
+}  // namespace boa
@@ -0,0 +1,103 @@
+#include "gtest/gtest.h"
+
+#include "Projection.h"
+#include "VarLiteral.h"
+#include "VarTable.h"
+
+#include <vector>
+
+using std::vector;
+
+namespace boa {
+
+class ProjectionTest : public ::testing::Test {
+ protected:
+  int nodes[4];
+  VarId x, y, z;
+
+  // Runs before each test.
+  void SetUp() {
+    VarTable::Clear();
+    x = VarTable::Intern(&nodes[0], false, VarTable::NO_TYPE, VarLiteral::MAX);
+    y = VarTable::Intern(&nodes[1], false, VarTable::NO_TYPE, VarLiteral::MAX);
+    z = VarTable::Intern(&nodes[2], false, VarTable::NO_TYPE, VarLiteral::MAX);
+  }
+
+  // left >= a * first + b * second
+  static Projection::Row MakeRow(double left, VarId first, double a, VarId second, double b,
+                                 Constraint::Type type = Constraint::NORMAL) {
+    Projection::Row row;
+    row.left_ = left;
+    row.coefs_[first] += a;
+    row.coefs_[second] += b;
+    row.type_ = type;
+    return row;
+  }
+
+  // keep x and z
+  static vector<bool> KeepXZ() {
+    vector<bool> keep(3, false);
+    keep[0] = keep[2] = true;
+    return keep;
+  }
+};
+
+TEST_F(ProjectionTest, Chain) {
+  // y >= x + 1, z >= 2y
+  Projection projection(10);
+  projection.AddRow(MakeRow(-1, x, 1, y, -1, Constraint::STRUCTURAL));
+  projection.AddRow(MakeRow(0, y, 2, z, -1, Constraint::ALIASING));
+  ASSERT_TRUE(projection.Project(KeepXZ()));
+
+  // z >= 2x + 2, normalized to -1 >= x - 0.5z
+  ASSERT_EQ(1u, projection.Size());
+  const Projection::Row& row = projection.GetRow(0);
+  ASSERT_EQ(2u, row.coefs_.size());
+  ASSERT_DOUBLE_EQ(1, row.coefs_.find(x)->second);
+  ASSERT_DOUBLE_EQ(-0.5, row.coefs_.find(z)->second);
+  ASSERT_DOUBLE_EQ(-1, row.left_);
+  ASSERT_EQ(Constraint::ALIASING, row.type_);
+}
+
+TEST_F(ProjectionTest, OneSided) {
+  // y >= x, y >= z - y is only bounded from below, and implies nothing on x and z.
+  Projection projection(10);
+  projection.AddRow(MakeRow(0, x, 1, y, -1));
+  projection.AddRow(MakeRow(0, z, 1, y, -1));
+  ASSERT_TRUE(projection.Project(KeepXZ()));
+  ASSERT_EQ(0u, projection.Size());
+}
+
+TEST_F(ProjectionTest, Duplicates) {
+  // y >= x + 1, y >= x + 3, z >= y - both paths give z >= x + k, the tighter one is kept.
+  Projection projection(10);
+  projection.AddRow(MakeRow(-1, x, 1, y, -1));
+  projection.AddRow(MakeRow(-3, x, 1, y, -1));
+  projection.AddRow(MakeRow(0, y, 1, z, -1));
+  ASSERT_TRUE(projection.Project(KeepXZ()));
+  ASSERT_EQ(1u, projection.Size());
+  ASSERT_DOUBLE_EQ(-3, projection.GetRow(0).left_);
+}
+
+TEST_F(ProjectionTest, Infeasable) {
+  // y >= 2, 1 >= y
+  Projection projection(10);
+  projection.AddRow(MakeRow(-2, y, -1, x, 0));
+  projection.AddRow(MakeRow(1, y, 1, x, 0));
+  ASSERT_FALSE(projection.Project(KeepXZ()));
+}
+
+TEST_F(ProjectionTest, TooManyRows) {
+  // Eliminating y from 2 lower and 2 upper bounds needs 4 rows.
+  VarId w = VarTable::Intern(&nodes[3], false, VarTable::NO_TYPE, VarLiteral::MAX);
+  Projection projection(3);
+  projection.AddRow(MakeRow(0, x, 1, y, -1));
+  projection.AddRow(MakeRow(0, w, 1, y, -1));
+  projection.AddRow(MakeRow(0, y, 1, z, -1));
+  projection.AddRow(MakeRow(0, y, 2, z, -1));
+  vector<bool> keep(4, true);
+  keep[1] = false;
+  ASSERT_FALSE(projection.Project(keep));
+}
+
+}  // namespace boa
@@ -0,0 +1,107 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <vector>
+
+#include "log.h"
+#include "ThreadPool.h"
+
+using std::stringstream;
+using std::vector;
+
+namespace boa {
+
+class CountJob : public Job {
+ public:
+  int id_;
+  int runs_;
+
+  explicit CountJob(int id) : id_(id), runs_(0) {}
+
+  virtual void Run() {
+    ++runs_;
+    LOG_ERROR << "job " << id_ << endl;
+  }
+};
+
+static void RunJobs(int threads) {
+  stringstream ss;
+  log::set(ss, log::Error);
+  vector<CountJob*> jobs;
+  for (int i = 0; i < 20; ++i) {
+    jobs.push_back(new CountJob(i));
+  }
+  ThreadPool::Run(vector<Job*>(jobs.begin(), jobs.end()), threads);
+
+  string logText = ss.str();
+  size_t last = 0;
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    ASSERT_EQ(1, jobs[i]->runs_);
+    stringstream line;
+    line << "job " << i << endl;
+    // Each job logs once, in job order
+    size_t pos = logText.find(line.str());
+    ASSERT_NE(string::npos, pos);
+    ASSERT_LE(last, pos);
+    last = pos;
+    delete jobs[i];
+  }
+  log::reset();
+}
+
+TEST(ThreadPoolTest, SingleThread) {
+  RunJobs(1);
+}
+
+TEST(ThreadPoolTest, ManyThreads) {
+  RunJobs(4);
+}
+
+// Each of the first jobs adds a follow up job once it is done.
+class FollowUpObserver : public JobObserver {
+ public:
+  vector<CountJob*> added_;
+  int done_;
+
+  FollowUpObserver() : done_(0) {}
+
+  virtual void Done(Job* job, vector<Job*>* more) {
+    ++done_;
+    if (static_cast<CountJob*>(job)->id_ < 10) {
+      added_.push_back(new CountJob(100 + static_cast<CountJob*>(job)->id_));
+      more->push_back(added_.back());
+    }
+  }
+};
+
+static void RunObserved(int threads) {
+  vector<CountJob*> jobs;
+  for (int i = 0; i < 10; ++i) {
+    jobs.push_back(new CountJob(i));
+  }
+  FollowUpObserver observer;
+  ThreadPool::Run(vector<Job*>(jobs.begin(), jobs.end()), threads, &observer);
+
+  ASSERT_EQ(20, observer.done_);
+  ASSERT_EQ(10u, observer.added_.size());
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    ASSERT_EQ(1, jobs[i]->runs_);
+    ASSERT_EQ(1, observer.added_[i]->runs_);
+    delete jobs[i];
+    delete observer.added_[i];
+  }
+}
+
+TEST(ThreadPoolTest, ObserverSingleThread) {
+  RunObserved(1);
+}
+
+TEST(ThreadPoolTest, ObserverManyThreads) {
+  RunObserved(4);
+}
+
+TEST(ThreadPoolTest, NoJobs) {
+  ThreadPool::Run(vector<Job*>(), 4);
+}
+
+}  // namespace boa
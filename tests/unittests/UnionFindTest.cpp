@@ -0,0 +1,28 @@
+#include "gtest/gtest.h"
+
+#include "UnionFind.h"
+
+namespace boa {
+
+TEST(UnionFindTest, Singletons) {
+  UnionFind sets(3);
+  ASSERT_EQ(3u, sets.Size());
+  for (uint32_t i = 0; i < 3; ++i) {
+    ASSERT_EQ(i, sets.Find(i));
+  }
+}
+
+TEST(UnionFindTest, Union) {
+  UnionFind sets(6);
+  sets.Union(0, 1);
+  sets.Union(2, 3);
+  sets.Union(1, 3);
+  ASSERT_EQ(sets.Find(0), sets.Find(2));
+  ASSERT_EQ(sets.Find(1), sets.Find(3));
+  ASSERT_NE(sets.Find(0), sets.Find(4));
+  ASSERT_NE(sets.Find(4), sets.Find(5));
+  sets.Union(3, 3);
+  ASSERT_EQ(sets.Find(0), sets.Find(3));
+}
+
+}  // namespace boa
@@ -0,0 +1,78 @@
+#include "gtest/gtest.h"
+
+#include "VarLiteral.h"
+#include "VarTable.h"
+
+#include <string>
+
+using std::string;
+
+namespace boa {
+
+class VarTableTest : public ::testing::Test {
+ protected:
+  // Runs before each test.
+  void SetUp() {
+    VarTable::Clear();
+  }
+};
+
+TEST_F(VarTableTest, InternIsStable) {
+  int node;
+  VarId a = VarTable::Intern(&node, false, VarLiteral::USED, VarLiteral::MAX);
+  VarId b = VarTable::Intern(&node, false, VarLiteral::USED, VarLiteral::MAX);
+  ASSERT_EQ(a, b);
+  ASSERT_EQ(1u, VarTable::Size());
+}
+
+TEST_F(VarTableTest, Find) {
+  int node;
+  VarId a = VarTable::Intern(&node, false, VarLiteral::USED, VarLiteral::MAX);
+  VarTable::Intern(&node, false, VarLiteral::USED, VarLiteral::MIN);
+  ASSERT_EQ(a, VarTable::Find(&node, false, VarLiteral::USED, VarLiteral::MAX));
+  ASSERT_EQ(2u, VarTable::Size());
+}
+
+TEST_F(VarTableTest, IdsAreDense) {
+  int node;
+  VarId a = VarTable::Intern(&node, false, VarLiteral::USED, VarLiteral::MAX);
+  VarId b = VarTable::Intern(&node, true, VarLiteral::USED, VarLiteral::MAX);
+  VarId c = VarTable::Intern(&node, false, VarLiteral::ALLOC, VarLiteral::MAX);
+  VarId d = VarTable::Intern(&node, false, VarTable::NO_TYPE, VarLiteral::MIN);
+  ASSERT_EQ(0u, a.Index());
+  ASSERT_EQ(1u, b.Index());
+  ASSERT_EQ(2u, c.Index());
+  ASSERT_EQ(3u, d.Index());
+  ASSERT_EQ(4u, VarTable::Size());
+}
+
+TEST_F(VarTableTest, Names) {
+  int node;
+  VarId write = VarTable::Intern(&node, false, VarLiteral::LEN_WRITE, VarLiteral::MAX);
+  VarId tmp = VarTable::Intern(&node, true, VarLiteral::ALLOC, VarLiteral::MIN);
+  VarId integer = VarTable::Intern(&node, false, VarTable::NO_TYPE, VarLiteral::MIN);
+
+  string w = VarTable::Name(write), t = VarTable::Name(tmp), i = VarTable::Name(integer);
+  ASSERT_EQ("v@", w.substr(0, 2));
+  ASSERT_EQ("!len-write!max", w.substr(w.length() - 14));
+  ASSERT_EQ("temp@", t.substr(0, 5));
+  ASSERT_EQ("!alloc!min", t.substr(t.length() - 10));
+  ASSERT_EQ(string::npos, i.find("used"));
+  ASSERT_EQ("!min", i.substr(i.length() - 4));
+
+  ASSERT_TRUE(VarTable::IsMax(write));
+  ASSERT_FALSE(VarTable::IsMax(tmp));
+}
+
+TEST_F(VarTableTest, Rename) {
+  int node, other;
+  VarId var = VarTable::Intern(&node, true, VarLiteral::LEN_READ, VarLiteral::MIN);
+  VarId renamed = VarTable::Rename(var, &other);
+  ASSERT_NE(var, renamed);
+  ASSERT_EQ(&node, VarTable::Node(var));
+  ASSERT_EQ(&other, VarTable::Node(renamed));
+  ASSERT_EQ(renamed, VarTable::Intern(&other, true, VarLiteral::LEN_READ, VarLiteral::MIN));
+  ASSERT_EQ(var, VarTable::Rename(renamed, &node));
+}
+
+}  // namespace boa
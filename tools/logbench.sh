@@ -0,0 +1,43 @@
+#!/bin/bash
+# Time boa on tests/realworld with logging disabled and with each log level enabled. Prints the
+# constraint generation time ("generation" phase of the profile), where the logging is, and the
+# time of the whole run, both per run over all the files.
+#
+# usage: tools/logbench.sh [runs]
+#
+# To measure what compiling log statements out saves, run it on a debug build
+# ("make clean; make MAX_LOG_LEVEL=2") and on an error build ("make MAX_LOG_LEVEL=0"), and compare
+# the "none" and "error" lines of the two.
+
+DIR=`dirname $0`/..
+BOA=$DIR/boa
+RUNS=${1:-3}
+PROFILE=`mktemp`
+
+# Wall time of a phase in ms, summed over all its occurrences
+phase() {
+  grep -o "\"name\": \"$1\", \"calls\": [0-9]*, \"wall_ms\": [0-9.e+-]*" $PROFILE |
+      awk '{ sum += $NF } END { print sum + 0 }'
+}
+
+run() {
+  local generation=0
+  local start=`date +%s%N`
+  for i in `seq $RUNS`; do
+    for file in `find $DIR/tests/realworld -name "*.c"`; do
+      $BOA "$@" -profile=$PROFILE $file > /dev/null 2>&1
+      generation=`awk "BEGIN { print $generation + \`phase generation\` }"`
+    done
+  done
+  local end=`date +%s%N`
+  printf "%10.1f %10d\n" `awk "BEGIN { print $generation / $RUNS }"` \
+      $(( (end - start) / 1000000 / RUNS ))
+}
+
+printf "%-12s %10s %10s\n" "log" "gen ms" "total ms"
+printf "%-12s %s\n" "none" "`run`"
+for level in error info debug trace; do
+  # Log to /dev/null so only the cost of formatting is measured
+  printf "%-12s %s\n" $level "`run -logfile=/dev/null -loglevel=$level`"
+done
+rm -f $PROFILE